@@ -17,7 +17,10 @@
 #include <limits>
 
 #include "ortools/base/logging.h"  // logging.h
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
 namespace math_opt_benchmark {
@@ -42,18 +45,34 @@ ExampleSolver::ExampleSolver(const math_opt::SolverType solver_type,
           .value();
 }
 
-ExampleSolution ExampleSolver::Solve() {
-  const math_opt::SolveResult solve_result = solver_->Solve().value();
-  CHECK_EQ(solve_result.termination.reason,
-           math_opt::TerminationReason::kOptimal)
-      << solve_result.termination;
+absl::StatusOr<ExampleSolution> ExampleSolver::Solve(
+    const absl::Duration time_limit) {
+  math_opt::SolveArguments solve_args;
+  solve_args.parameters.time_limit = time_limit;
+  const absl::StatusOr<math_opt::SolveResult> solve_result =
+      solver_->Solve(solve_args);
+  if (!solve_result.ok()) {
+    return solve_result.status();
+  }
+  const math_opt::TerminationReason reason = solve_result->termination.reason;
+  if (reason == math_opt::TerminationReason::kNoSolutionFound) {
+    return absl::DeadlineExceededError(
+        absl::StrCat("No solution found: ", solve_result->termination.detail));
+  }
+  if (reason != math_opt::TerminationReason::kOptimal &&
+      reason != math_opt::TerminationReason::kFeasible) {
+    return absl::InternalError(absl::StrCat(
+        "Unexpected termination: ", solve_result->termination.detail));
+  }
   ExampleSolution result;
-  result.objective_value = solve_result.objective_value();
+  result.objective_value = solve_result->objective_value();
+  result.optimal = reason == math_opt::TerminationReason::kOptimal;
   for (const math_opt::Variable x : x_vars_) {
-    result.x_values.push_back(solve_result.variable_values().at(x));
+    result.x_values.push_back(solve_result->variable_values().at(x));
   }
   return result;
 }
+
 void ExampleSolver::UpdateObjective(int index, double value) {
   model_.set_objective_coefficient(x_vars_.at(index), value);
 }
@@ -18,6 +18,8 @@
 #include <memory>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "third_party/ortools/ortools/math_opt/cpp/math_opt.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
@@ -39,13 +41,19 @@ struct ExampleProblem {
 struct ExampleSolution {
   double objective_value;
   std::vector<double> x_values;
+  // False if the time limit stopped the solve, x_values is then the best
+  // solution found
+  bool optimal = true;
 };
 
 class ExampleSolver {
  public:
   ExampleSolver(operations_research::math_opt::SolverType solver_type,
                 const ExampleProblem& problem);
-  ExampleSolution Solve();
+  // Returns an error if the solve failed, or if the time limit was reached
+  // before any solution was found.
+  absl::StatusOr<ExampleSolution> Solve(
+      absl::Duration time_limit = absl::InfiniteDuration());
   void UpdateObjective(int index, double value);
 
  private:
@@ -18,7 +18,9 @@
 #include "ortools/base/init_google.h"
 #include "absl/flags/flag.h"
 #include "absl/random/random.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "math_opt_benchmark/example/example.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
@@ -26,6 +28,9 @@ ABSL_FLAG(int, num_vars, 10, "How many variables are in the problem.");
 ABSL_FLAG(double, rhs, 4.0, "How many variables can be selected.");
 ABSL_FLAG(bool, use_integers, false, "If the variables should be integer.");
 
+ABSL_FLAG(absl::Duration, time_limit, absl::InfiniteDuration(),
+          "Time limit of each solve.");
+
 ABSL_FLAG(operations_research::math_opt::SolverType, solver,
           operations_research::math_opt::SolverType::kGlop,
           "The solver to use. Set to \"gscip\" or \"glop\"");
@@ -33,10 +38,15 @@ ABSL_FLAG(operations_research::math_opt::SolverType, solver,
 namespace math_opt_benchmark {
 namespace {
 
-void PrintSolution(const ExampleSolution& solution) {
-  std::cout << "Solution objective: " << solution.objective_value << std::endl;
+void PrintSolution(const absl::StatusOr<ExampleSolution>& solution) {
+  if (!solution.ok()) {
+    std::cout << "No solution: " << solution.status() << std::endl;
+    return;
+  }
+  std::cout << "Solution objective: " << solution->objective_value
+            << (solution->optimal ? "" : " (time limit)") << std::endl;
   std::cout << "Solution variable values: "
-            << absl::StrJoin(solution.x_values, ",") << std::endl;
+            << absl::StrJoin(solution->x_values, ",") << std::endl;
 }
 
 void Main() {
@@ -51,12 +61,13 @@ void Main() {
   std::cout << "Objective coefficeints: ["
             << absl::StrJoin(problem.objective, ",") << "]" << std::endl;
   ExampleSolver solver(absl::GetFlag(FLAGS_solver), problem);
-  PrintSolution(solver.Solve());
+  const absl::Duration time_limit = absl::GetFlag(FLAGS_time_limit);
+  PrintSolution(solver.Solve(time_limit));
   std::cout << "Zeroing objective for first half of variables" << std::endl;
   for (int i = 0; i < num_vars / 2; ++i) {
     solver.UpdateObjective(i, 0.0);
   }
-  PrintSolution(solver.Solve());
+  PrintSolution(solver.Solve(time_limit));
 }
 
 }  // namespace
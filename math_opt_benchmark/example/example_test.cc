@@ -16,6 +16,9 @@
 
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "third_party/ortools/ortools/math_opt/cpp/math_opt.h"
@@ -35,10 +38,12 @@ TEST(ExampleSolverTest, OneVariable) {
   problem.objective = {3.5};
   problem.integer = false;
   ExampleSolver solver(math_opt::SolverType::kGlop, problem);
-  const ExampleSolution solution = solver.Solve();
-  EXPECT_NEAR(solution.objective_value, 3.5, kTolerance);
+  const absl::StatusOr<ExampleSolution> solution = solver.Solve();
+  ASSERT_TRUE(solution.ok()) << solution.status();
+  EXPECT_TRUE(solution->optimal);
+  EXPECT_NEAR(solution->objective_value, 3.5, kTolerance);
   const std::vector<double> expected_var_values = {1.0};
-  EXPECT_THAT(solution.x_values,
+  EXPECT_THAT(solution->x_values,
               Pointwise(DoubleNear(kTolerance), expected_var_values));
 }
 
@@ -48,10 +53,12 @@ TEST(ExampleSolverTest, TwoOfThreeInteger) {
   problem.objective = {4.0, 2.0, 6.0};
   problem.integer = true;
   ExampleSolver solver(math_opt::SolverType::kGscip, problem);
-  const ExampleSolution solution = solver.Solve();
-  EXPECT_NEAR(solution.objective_value, 10.0, kTolerance);
+  const absl::StatusOr<ExampleSolution> solution = solver.Solve();
+  ASSERT_TRUE(solution.ok()) << solution.status();
+  EXPECT_TRUE(solution->optimal);
+  EXPECT_NEAR(solution->objective_value, 10.0, kTolerance);
   const std::vector<double> expected_var_values = {1.0, 0.0, 1.0};
-  EXPECT_THAT(solution.x_values,
+  EXPECT_THAT(solution->x_values,
               Pointwise(DoubleNear(kTolerance), expected_var_values));
 }
 
@@ -61,10 +68,12 @@ TEST(ExampleSolverTest, FractionalRhsContinuousVariables) {
   problem.objective = {4.0, 2.0, 6.0};
   problem.integer = false;
   ExampleSolver solver(math_opt::SolverType::kGlop, problem);
-  const ExampleSolution solution = solver.Solve();
-  EXPECT_NEAR(solution.objective_value, 11.0, kTolerance);
+  const absl::StatusOr<ExampleSolution> solution = solver.Solve();
+  ASSERT_TRUE(solution.ok()) << solution.status();
+  EXPECT_TRUE(solution->optimal);
+  EXPECT_NEAR(solution->objective_value, 11.0, kTolerance);
   const std::vector<double> expected_var_values = {1.0, 0.5, 1.0};
-  EXPECT_THAT(solution.x_values,
+  EXPECT_THAT(solution->x_values,
               Pointwise(DoubleNear(kTolerance), expected_var_values));
 }
 
@@ -74,14 +83,46 @@ TEST(ExampleSolverTest, Update) {
   problem.objective = {4.0, 2.0, 6.0};
   problem.integer = false;
   ExampleSolver solver(math_opt::SolverType::kGlop, problem);
-  EXPECT_NEAR(10.0, solver.Solve().objective_value, kTolerance);
+  EXPECT_NEAR(10.0, solver.Solve().value().objective_value, kTolerance);
   solver.UpdateObjective(1, 5.0);
-  const ExampleSolution solution = solver.Solve();
-  EXPECT_NEAR(solution.objective_value, 11.0, kTolerance);
+  const absl::StatusOr<ExampleSolution> solution = solver.Solve();
+  ASSERT_TRUE(solution.ok()) << solution.status();
+  EXPECT_TRUE(solution->optimal);
+  EXPECT_NEAR(solution->objective_value, 11.0, kTolerance);
   const std::vector<double> expected_var_values = {0.0, 1.0, 1.0};
-  EXPECT_THAT(solution.x_values,
+  EXPECT_THAT(solution->x_values,
               Pointwise(DoubleNear(kTolerance), expected_var_values));
 }
 
+TEST(ExampleSolverTest, TimeLimit) {
+  ExampleProblem problem;
+  problem.rhs = 2.1;
+  problem.objective = {4.0, 2.0, 6.0};
+  problem.integer = true;
+  ExampleSolver solver(math_opt::SolverType::kGscip, problem);
+  const absl::StatusOr<ExampleSolution> solution =
+      solver.Solve(absl::Seconds(10));
+  ASSERT_TRUE(solution.ok()) << solution.status();
+  EXPECT_TRUE(solution->optimal);
+  EXPECT_NEAR(solution->objective_value, 10.0, kTolerance);
+}
+
+TEST(ExampleSolverTest, ExpiredTimeLimit) {
+  ExampleProblem problem;
+  problem.rhs = 2.1;
+  problem.objective = {4.0, 2.0, 6.0};
+  problem.integer = true;
+  ExampleSolver solver(math_opt::SolverType::kGscip, problem);
+  const absl::StatusOr<ExampleSolution> solution =
+      solver.Solve(absl::ZeroDuration());
+  // Depending on when the solver checks the limit it stops either before or
+  // after finding a first solution, but never proves optimality.
+  if (solution.ok()) {
+    EXPECT_FALSE(solution->optimal);
+  } else {
+    EXPECT_EQ(solution.status().code(), absl::StatusCode::kDeadlineExceeded);
+  }
+}
+
 }  // namespace
 }  // namespace math_opt_benchmark
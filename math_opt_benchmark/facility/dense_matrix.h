@@ -0,0 +1,146 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MATH_OPT_BENCHMARK_FACILITY_DENSE_MATRIX_H_
+#define MATH_OPT_BENCHMARK_FACILITY_DENSE_MATRIX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "absl/types/span.h"
+#include "ortools/base/logging.h"
+
+namespace math_opt_benchmark {
+
+// A dense row-major matrix backed by a single cache-line aligned buffer.
+//
+// Rows are contiguous and handed out as spans, so matrix[i][j] reads like a
+// std::vector<std::vector<T>> while iterating over all entries streams through
+// memory linearly.
+template <typename T>
+class DenseMatrix {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "DenseMatrix only holds trivially copyable values");
+
+ public:
+  static constexpr std::size_t kAlignment = 64;
+
+  DenseMatrix() = default;
+  DenseMatrix(int num_rows, int num_cols, T value = T())
+      : num_rows_(num_rows),
+        num_cols_(num_cols),
+        data_(Allocate(static_cast<std::size_t>(num_rows) * num_cols)) {
+    CHECK_GE(num_rows, 0);
+    CHECK_GE(num_cols, 0);
+    std::fill_n(data_.get(), size(), value);
+  }
+  // Every row must have the same length, e.g. {{1, 2}, {3, 4}}.
+  DenseMatrix(std::initializer_list<std::initializer_list<T>> rows)
+      : DenseMatrix(rows.size(), rows.size() == 0 ? 0 : rows.begin()->size()) {
+    T* out = data_.get();
+    for (const std::initializer_list<T>& row : rows) {
+      CHECK_EQ(row.size(), num_cols_);
+      out = std::copy(row.begin(), row.end(), out);
+    }
+  }
+
+  DenseMatrix(const DenseMatrix& other)
+      : num_rows_(other.num_rows_),
+        num_cols_(other.num_cols_),
+        data_(Allocate(other.size())) {
+    std::copy_n(other.data_.get(), size(), data_.get());
+  }
+  DenseMatrix& operator=(const DenseMatrix& other) {
+    if (this != &other) {
+      *this = DenseMatrix(other);
+    }
+    return *this;
+  }
+  DenseMatrix(DenseMatrix&& other) noexcept
+      : num_rows_(other.num_rows_),
+        num_cols_(other.num_cols_),
+        data_(std::move(other.data_)) {
+    other.num_rows_ = 0;
+    other.num_cols_ = 0;
+  }
+  DenseMatrix& operator=(DenseMatrix&& other) noexcept {
+    num_rows_ = other.num_rows_;
+    num_cols_ = other.num_cols_;
+    data_ = std::move(other.data_);
+    other.num_rows_ = 0;
+    other.num_cols_ = 0;
+    return *this;
+  }
+
+  int num_rows() const { return num_rows_; }
+  int num_cols() const { return num_cols_; }
+  std::size_t size() const {
+    return static_cast<std::size_t>(num_rows_) * num_cols_;
+  }
+
+  absl::Span<T> operator[](int row) {
+    return absl::Span<T>(data_.get() + Offset(row), num_cols_);
+  }
+  absl::Span<const T> operator[](int row) const {
+    return absl::Span<const T>(data_.get() + Offset(row), num_cols_);
+  }
+
+  // All entries in row-major order.
+  absl::Span<T> values() { return absl::Span<T>(data_.get(), size()); }
+  absl::Span<const T> values() const {
+    return absl::Span<const T>(data_.get(), size());
+  }
+
+  // Returns a copy with rows and columns swapped, e.g. a facility-major view
+  // of a customer-major cost matrix.
+  DenseMatrix Transposed() const {
+    DenseMatrix result(num_cols_, num_rows_);
+    for (int i = 0; i < num_rows_; i++) {
+      const T* row = data_.get() + Offset(i);
+      for (int j = 0; j < num_cols_; j++) {
+        result.data_[result.Offset(j) + i] = row[j];
+      }
+    }
+    return result;
+  }
+
+ private:
+  struct AlignedDeleter {
+    void operator()(T* ptr) const {
+      ::operator delete(ptr, std::align_val_t(kAlignment));
+    }
+  };
+
+  static std::unique_ptr<T[], AlignedDeleter> Allocate(std::size_t size) {
+    return std::unique_ptr<T[], AlignedDeleter>(static_cast<T*>(
+        ::operator new(std::max<std::size_t>(size, 1) * sizeof(T),
+                       std::align_val_t(kAlignment))));
+  }
+
+  std::size_t Offset(int row) const {
+    return static_cast<std::size_t>(row) * num_cols_;
+  }
+
+  int num_rows_ = 0;
+  int num_cols_ = 0;
+  std::unique_ptr<T[], AlignedDeleter> data_;
+};
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_FACILITY_DENSE_MATRIX_H_
@@ -0,0 +1,67 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/dense_matrix.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+TEST(DenseMatrixTest, RowMajorLayout) {
+  const DenseMatrix<double> matrix = {{1, 2, 3}, {4, 5, 6}};
+  EXPECT_THAT(matrix.num_rows(), Eq(2));
+  EXPECT_THAT(matrix.num_cols(), Eq(3));
+  EXPECT_THAT(matrix[0], ElementsAre(1, 2, 3));
+  EXPECT_THAT(matrix[1], ElementsAre(4, 5, 6));
+  EXPECT_THAT(matrix.values(), ElementsAre(1, 2, 3, 4, 5, 6));
+  EXPECT_EQ(matrix[1].data(), matrix[0].data() + 3);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(matrix.values().data()) %
+                DenseMatrix<double>::kAlignment,
+            0);
+}
+
+TEST(DenseMatrixTest, FillAndWrite) {
+  DenseMatrix<int> matrix(2, 2, 7);
+  matrix[1][0] = 3;
+  EXPECT_THAT(matrix.values(), ElementsAre(7, 7, 3, 7));
+}
+
+TEST(DenseMatrixTest, Transposed) {
+  const DenseMatrix<double> matrix = {{1, 2, 3}, {4, 5, 6}};
+  const DenseMatrix<double> transposed = matrix.Transposed();
+  EXPECT_THAT(transposed.num_rows(), Eq(3));
+  EXPECT_THAT(transposed.num_cols(), Eq(2));
+  EXPECT_THAT(transposed.values(), ElementsAre(1, 4, 2, 5, 3, 6));
+}
+
+TEST(DenseMatrixTest, CopyIsDeep) {
+  DenseMatrix<double> matrix = {{1, 2}};
+  const DenseMatrix<double> copy = matrix;
+  matrix[0][0] = 5;
+  EXPECT_THAT(copy[0], ElementsAre(1, 2));
+  DenseMatrix<double> moved = std::move(matrix);
+  EXPECT_THAT(moved[0], ElementsAre(5, 2));
+  EXPECT_THAT(matrix.num_rows(), Eq(0));
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
@@ -0,0 +1,274 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/local_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "math_opt_benchmark/facility/parallel_for.h"
+#include "ortools/base/logging.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr int kCustomersPerShard = 256;
+// Swaps need a facility by open facility table, skipped beyond this size
+constexpr int64_t kMaxSwapEntries = int64_t{1} << 22;
+
+// Cost change of opening facility `to_open` and closing `to_close`. Negative
+// improves the solution. -1 stands for no facility.
+struct Move {
+  double delta = 0.0;
+  int to_open = -1;
+  int to_close = -1;
+};
+
+class Search {
+ public:
+  Search(absl::Span<const double> open_costs,
+         const DenseMatrix<double>& sorted_costs, const FacilityOrder& order,
+         int num_threads)
+      : open_costs_(open_costs),
+        sorted_costs_(sorted_costs),
+        order_(order),
+        num_threads_(num_threads),
+        num_facilities_(open_costs.size()),
+        num_shards_((sorted_costs.num_rows() + kCustomersPerShard - 1) /
+                    kCustomersPerShard),
+        shard_gains_(num_shards_, num_facilities_),
+        shard_losses_(num_shards_, num_facilities_),
+        shard_swaps_(num_shards_),
+        shard_costs_(num_shards_),
+        gains_(num_facilities_),
+        losses_(num_facilities_),
+        // Room for the most open facilities whose swaps are tracked
+        swap_extras_(int64_t{num_facilities_} *
+                     std::min<int64_t>(num_facilities_,
+                                       kMaxSwapEntries / num_facilities_)),
+        slots_(num_facilities_, -1) {}
+
+  // Evaluates every move from `open`, returns the cost of `open`
+  double Evaluate(const std::vector<double>& open) {
+    int num_open = 0;
+    for (int j = 0; j < num_facilities_; j++) {
+      slots_[j] = open[j] > 0.5 ? num_open++ : -1;
+    }
+    num_open_ = num_open;
+    // With a single open facility a customer has no second choice, so only
+    // adds are evaluated
+    track_swaps_ = num_open >= 2 &&
+                   int64_t{num_facilities_} * num_open <= kMaxSwapEntries;
+
+    ParallelFor(num_threads_, num_shards_, [&](int shard) {
+      order_.Visit([&](const auto& indices) { EvaluateShard(shard, indices); });
+    });
+
+    double cost = 0.0;
+    for (int j = 0; j < num_facilities_; j++) {
+      if (slots_[j] >= 0) {
+        cost += open_costs_[j];
+      }
+    }
+    std::fill(gains_.begin(), gains_.end(), 0.0);
+    std::fill(losses_.begin(), losses_.end(), 0.0);
+    if (track_swaps_) {
+      std::fill_n(swap_extras_.begin(), int64_t{num_facilities_} * num_open,
+                  0.0);
+    }
+    // Reduced in shard order so the moves do not depend on scheduling
+    for (int shard = 0; shard < num_shards_; shard++) {
+      cost += shard_costs_[shard];
+      const absl::Span<const double> gains = shard_gains_[shard];
+      const absl::Span<const double> losses = shard_losses_[shard];
+      for (int j = 0; j < num_facilities_; j++) {
+        gains_[j] += gains[j];
+        losses_[j] += losses[j];
+      }
+      for (const SwapEntry& entry : shard_swaps_[shard]) {
+        swap_extras_[SwapIndex(entry.closed, entry.slot)] += entry.value;
+      }
+    }
+    return cost;
+  }
+
+  // The most improving move evaluated by the last Evaluate
+  Move BestMove() const {
+    Move best;
+    for (int a = 0; a < num_facilities_; a++) {
+      if (slots_[a] >= 0) {
+        continue;
+      }
+      const double add = open_costs_[a] - gains_[a];
+      if (add < best.delta) {
+        best = {add, a, -1};
+      }
+      if (!track_swaps_) {
+        continue;
+      }
+      for (int b = 0; b < num_facilities_; b++) {
+        if (slots_[b] < 0) {
+          continue;
+        }
+        const double swap = add - open_costs_[b] + losses_[b] -
+                            swap_extras_[SwapIndex(a, slots_[b])];
+        if (swap < best.delta) {
+          best = {swap, a, b};
+        }
+      }
+    }
+    if (num_open_ >= 2) {
+      for (int b = 0; b < num_facilities_; b++) {
+        const double drop = losses_[b] - open_costs_[b];
+        if (slots_[b] >= 0 && drop < best.delta) {
+          best = {drop, -1, b};
+        }
+      }
+    }
+    return best;
+  }
+
+ private:
+  int64_t SwapIndex(int closed, int slot) const {
+    return int64_t{closed} * num_open_ + slot;
+  }
+
+  struct SwapEntry {
+    int closed;
+    int slot;
+    double value;
+  };
+
+  // For a customer served by b at cost best, with second cheapest open cost
+  // second:
+  //  - opening a saves max(0, best - c_a), accumulated in gains
+  //  - closing b costs second - best, accumulated in losses
+  //  - swapping a for b changes the cost by the two above plus
+  //    second - max(c_a, best) when c_a < second, accumulated in swaps
+  template <typename Index>
+  void EvaluateShard(int shard, const DenseMatrix<Index>& indices) {
+    const absl::Span<double> gains = shard_gains_[shard];
+    const absl::Span<double> losses = shard_losses_[shard];
+    std::vector<SwapEntry>& swaps = shard_swaps_[shard];
+    std::fill(gains.begin(), gains.end(), 0.0);
+    std::fill(losses.begin(), losses.end(), 0.0);
+    swaps.clear();
+    double cost = 0.0;
+    const int end = std::min(sorted_costs_.num_rows(),
+                             (shard + 1) * kCustomersPerShard);
+    for (int i = shard * kCustomersPerShard; i < end; i++) {
+      const absl::Span<const double> costs = sorted_costs_[i];
+      const absl::Span<const Index> facilities = indices[i];
+      int first = 0;
+      while (slots_[facilities[first]] < 0) {
+        first++;
+      }
+      const double best = costs[first];
+      cost += best;
+      for (int k = 0; k < first; k++) {
+        gains[facilities[k]] += best - costs[k];
+      }
+      if (num_open_ < 2) {
+        continue;
+      }
+      int second = first + 1;
+      while (slots_[facilities[second]] < 0) {
+        second++;
+      }
+      const double next = costs[second];
+      const int b = facilities[first];
+      losses[b] += next - best;
+      if (!track_swaps_) {
+        continue;
+      }
+      for (int k = 0; k < second; k++) {
+        if (k != first) {
+          swaps.push_back({static_cast<int>(facilities[k]), slots_[b],
+                           next - std::max(costs[k], best)});
+        }
+      }
+    }
+    shard_costs_[shard] = cost;
+  }
+
+  absl::Span<const double> open_costs_;
+  const DenseMatrix<double>& sorted_costs_;
+  const FacilityOrder& order_;
+  const int num_threads_;
+  const int num_facilities_;
+  const int num_shards_;
+  DenseMatrix<double> shard_gains_;
+  DenseMatrix<double> shard_losses_;
+  std::vector<std::vector<SwapEntry>> shard_swaps_;
+  std::vector<double> shard_costs_;
+  std::vector<double> gains_;
+  std::vector<double> losses_;
+  // Extra saving of each closed facility by open facility swap, num_open_
+  // entries per facility. Sized once for the largest tracked num_open_.
+  std::vector<double> swap_extras_;
+  // Position of each open facility among the open ones, -1 if closed
+  std::vector<int> slots_;
+  int num_open_ = 0;
+  bool track_swaps_ = false;
+};
+
+}  // namespace
+
+LocalSearchResult LocalSearch(absl::Span<const double> open_costs,
+                              const DenseMatrix<double>& sorted_costs,
+                              const FacilityOrder& order,
+                              absl::Span<const double> open_values,
+                              int num_threads) {
+  const int num_facilities = open_costs.size();
+  CHECK_EQ(open_values.size(), num_facilities);
+  CHECK_GT(num_facilities, 0);
+  LocalSearchResult result;
+  result.open_values.assign(num_facilities, 0.0);
+  int most_open = 0;
+  for (int j = 0; j < num_facilities; j++) {
+    if (open_values[j] >= 0.5) {
+      result.open_values[j] = 1.0;
+    }
+    if (open_values[j] > open_values[most_open]) {
+      most_open = j;
+    }
+  }
+  result.open_values[most_open] = 1.0;
+
+  Search search(open_costs, sorted_costs, order, num_threads);
+  result.cost = search.Evaluate(result.open_values);
+  while (true) {
+    const Move move = search.BestMove();
+    // Relative threshold so rounding noise in the deltas cannot cycle
+    if (move.delta >= -1e-9 * std::max(1.0, std::abs(result.cost))) {
+      break;
+    }
+    if (move.to_open >= 0) {
+      result.open_values[move.to_open] = 1.0;
+    }
+    if (move.to_close >= 0) {
+      result.open_values[move.to_close] = 0.0;
+    }
+    result.num_moves++;
+    result.cost = search.Evaluate(result.open_values);
+  }
+  return result;
+}
+
+}  // namespace math_opt_benchmark
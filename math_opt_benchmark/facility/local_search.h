@@ -0,0 +1,54 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Add, drop and swap local search for uncapacitated facility location.
+//
+// Every customer is served by its cheapest open facility. A pass walks each
+// customer's presorted costs up to its second cheapest open facility, which
+// gives the exact cost change of opening any facility, closing any open one
+// and swapping the two, so the best move is applied without re-evaluating
+// the solution per candidate.
+
+#ifndef MATH_OPT_BENCHMARK_FACILITY_LOCAL_SEARCH_H_
+#define MATH_OPT_BENCHMARK_FACILITY_LOCAL_SEARCH_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "math_opt_benchmark/facility/dense_matrix.h"
+#include "math_opt_benchmark/facility/sorted_costs.h"
+
+namespace math_opt_benchmark {
+
+struct LocalSearchResult {
+  // 0/1 open values of the improved solution
+  std::vector<double> open_values;
+  double cost = 0.0;
+  int num_moves = 0;
+};
+
+// Rounds `open_values` up from 0.5 (opening the most open facility if none
+// is) and applies the best improving add, drop or swap move until there is
+// none. `sorted_costs` holds every customer's supply costs in increasing order
+// and `order` the matching facilities, as produced by SortCosts. Customers are
+// spread over num_threads threads, the result does not depend on their count.
+LocalSearchResult LocalSearch(absl::Span<const double> open_costs,
+                              const DenseMatrix<double>& sorted_costs,
+                              const FacilityOrder& order,
+                              absl::Span<const double> open_values,
+                              int num_threads);
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_FACILITY_LOCAL_SEARCH_H_
@@ -0,0 +1,138 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/local_search.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "math_opt_benchmark/facility/dense_matrix.h"
+#include "math_opt_benchmark/facility/sorted_costs.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+constexpr double kTolerance = 1e-9;
+
+double SolutionCost(const std::vector<double>& open_costs,
+                    const DenseMatrix<double>& costs,
+                    const std::vector<double>& open_values) {
+  double cost = 0.0;
+  for (int j = 0; j < open_costs.size(); j++) {
+    cost += open_costs[j] * open_values[j];
+  }
+  for (int i = 0; i < costs.num_rows(); i++) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int j = 0; j < costs.num_cols(); j++) {
+      if (open_values[j] > 0.5) {
+        best = std::min(best, costs[i][j]);
+      }
+    }
+    cost += best;
+  }
+  return cost;
+}
+
+// The cheapest solution over every non-empty set of open facilities
+double OptimalCost(const std::vector<double>& open_costs,
+                   const DenseMatrix<double>& costs) {
+  const int num_facilities = open_costs.size();
+  double optimum = std::numeric_limits<double>::infinity();
+  for (int set = 1; set < (1 << num_facilities); set++) {
+    std::vector<double> open_values(num_facilities);
+    for (int j = 0; j < num_facilities; j++) {
+      open_values[j] = (set >> j) & 1;
+    }
+    optimum = std::min(optimum, SolutionCost(open_costs, costs, open_values));
+  }
+  return optimum;
+}
+
+DenseMatrix<double> MakeCosts(int num_customers, int num_facilities) {
+  DenseMatrix<double> costs(num_customers, num_facilities);
+  for (int i = 0; i < num_customers; i++) {
+    for (int j = 0; j < num_facilities; j++) {
+      costs[i][j] = (i * 37 + j * 101) % 53 + 1;
+    }
+  }
+  return costs;
+}
+
+TEST(LocalSearchTest, AddsProfitableFacility) {
+  // Only facility 0 is open in the start, facility 1 serves both customers
+  // much more cheaply
+  const std::vector<double> open_costs = {1.0, 1.0, 10.0};
+  DenseMatrix<double> costs = {{5, 1, 2}, {5, 1, 3}};
+  const DenseMatrix<double> original = costs;
+  const FacilityOrder order = SortCosts(costs, 1);
+  const LocalSearchResult result =
+      LocalSearch(open_costs, costs, order, {1.0, 0.0, 0.0}, 1);
+  EXPECT_THAT(result.open_values, ElementsAre(0.0, 1.0, 0.0));
+  EXPECT_NEAR(result.cost, 3.0, kTolerance);
+  EXPECT_NEAR(result.cost, SolutionCost(open_costs, original, result.open_values),
+              kTolerance);
+  EXPECT_GT(result.num_moves, 0);
+}
+
+TEST(LocalSearchTest, RoundsFractionalStart) {
+  const std::vector<double> open_costs = {1.0, 1.0};
+  DenseMatrix<double> costs = {{1, 2}, {2, 1}};
+  const FacilityOrder order = SortCosts(costs, 1);
+  // Nothing is half open, so the most open facility is
+  const LocalSearchResult result =
+      LocalSearch(open_costs, costs, order, {0.1, 0.3}, 1);
+  EXPECT_NEAR(result.cost, 4.0, kTolerance);
+}
+
+TEST(LocalSearchTest, ImprovesAndMatchesExactCost) {
+  const int num_facilities = 8;
+  const std::vector<double> open_costs = {30, 12, 45, 20, 8, 60, 25, 15};
+  DenseMatrix<double> costs = MakeCosts(40, num_facilities);
+  const DenseMatrix<double> original = costs;
+  const FacilityOrder order = SortCosts(costs, 1);
+  const std::vector<double> start(num_facilities, 1.0);
+  const LocalSearchResult result = LocalSearch(open_costs, costs, order, start, 1);
+  EXPECT_NEAR(result.cost, SolutionCost(open_costs, original, result.open_values),
+              kTolerance);
+  EXPECT_LE(result.cost, SolutionCost(open_costs, original, start));
+  EXPECT_GE(result.cost, OptimalCost(open_costs, original) - kTolerance);
+}
+
+TEST(LocalSearchTest, ThreadsDoNotChangeResult) {
+  const int num_facilities = 12;
+  std::vector<double> open_costs(num_facilities);
+  for (int j = 0; j < num_facilities; j++) {
+    open_costs[j] = 200 + (j * 53) % 97;
+  }
+  DenseMatrix<double> costs = MakeCosts(1000, num_facilities);
+  const FacilityOrder order = SortCosts(costs, 1);
+  std::vector<double> start(num_facilities, 0.0);
+  start[3] = 1.0;
+  const LocalSearchResult serial =
+      LocalSearch(open_costs, costs, order, start, 1);
+  const LocalSearchResult parallel =
+      LocalSearch(open_costs, costs, order, start, 4);
+  EXPECT_THAT(parallel.open_values, ElementsAreArray(serial.open_values));
+  EXPECT_EQ(parallel.cost, serial.cost);
+  EXPECT_EQ(parallel.num_moves, serial.num_moves);
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
@@ -0,0 +1,164 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MATH_OPT_BENCHMARK_FACILITY_PARALLEL_FOR_H_
+#define MATH_OPT_BENCHMARK_FACILITY_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+
+namespace math_opt_benchmark {
+
+// Calls fn(shard) for every shard in [0, num_shards) using up to num_threads
+// threads, including the calling one. Shards are handed out dynamically, so fn
+// must only write to state owned by its shard for the result to be
+// deterministic. With num_threads <= 1 the shards run in order on the calling
+// thread.
+template <typename Fn>
+void ParallelFor(int num_threads, int num_shards, const Fn& fn) {
+  num_threads = std::min(num_threads, num_shards);
+  if (num_threads <= 1) {
+    for (int shard = 0; shard < num_shards; shard++) {
+      fn(shard);
+    }
+    return;
+  }
+  std::atomic<int> next_shard(0);
+  const auto worker = [&]() {
+    for (int shard = next_shard++; shard < num_shards; shard = next_shard++) {
+      fn(shard);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int i = 0; i < num_threads - 1; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+// A fixed set of worker threads that runs ParallelFor style loops without
+// creating threads per call, for loops run once per iteration of a solver.
+// The calling thread also takes shards, so a pool of num_threads starts
+// num_threads - 1 workers. Run is not reentrant and must not be called
+// concurrently.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads) {
+    for (int i = 0; i < num_threads - 1; i++) {
+      workers_.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      absl::MutexLock lock(&mutex_);
+      stop_ = true;
+    }
+    for (std::thread& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  // Same contract as ParallelFor(num_threads(), num_shards, fn).
+  template <typename Fn>
+  void Run(int num_shards, const Fn& fn) {
+    if (workers_.empty() || num_shards <= 1) {
+      for (int shard = 0; shard < num_shards; shard++) {
+        fn(shard);
+      }
+      return;
+    }
+    const std::function<void(int)> task = [&fn](int shard) { fn(shard); };
+    {
+      absl::MutexLock lock(&mutex_);
+      task_ = &task;
+      num_shards_ = num_shards;
+      next_shard_ = 0;
+      busy_ = workers_.size();
+      generation_++;
+    }
+    RunShards(task, num_shards);
+    // Every worker must check in before returning, since task lives on this
+    // stack frame and a late worker would otherwise see the next generation's
+    // shard counter.
+    absl::MutexLock lock(&mutex_);
+    const auto done = [this]() { return busy_ == 0; };
+    mutex_.Await(absl::Condition(&done));
+    task_ = nullptr;
+  }
+
+ private:
+  void RunShards(const std::function<void(int)>& task, int num_shards) {
+    for (int shard = next_shard_++; shard < num_shards; shard = next_shard_++) {
+      task(shard);
+    }
+  }
+
+  void WorkerLoop() {
+    int seen = 0;
+    while (true) {
+      const std::function<void(int)>* task;
+      int num_shards;
+      {
+        absl::MutexLock lock(&mutex_);
+        const auto woken = [this, seen]() {
+          return stop_ || generation_ != seen;
+        };
+        mutex_.Await(absl::Condition(&woken));
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+        task = task_;
+        num_shards = num_shards_;
+      }
+      RunShards(*task, num_shards);
+      absl::MutexLock lock(&mutex_);
+      busy_--;
+    }
+  }
+
+  absl::Mutex mutex_;
+  bool stop_ = false;
+  int generation_ = 0;
+  int busy_ = 0;
+  int num_shards_ = 0;
+  const std::function<void(int)>* task_ = nullptr;
+  std::atomic<int> next_shard_{0};
+  std::vector<std::thread> workers_;
+};
+
+// ParallelFor on the threads of pool.
+template <typename Fn>
+void ParallelFor(ThreadPool* pool, int num_shards, const Fn& fn) {
+  pool->Run(num_shards, fn);
+}
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_FACILITY_PARALLEL_FOR_H_
@@ -0,0 +1,65 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/parallel_for.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+TEST(ParallelForTest, SerialRunsInOrder) {
+  std::vector<int> order;
+  ParallelFor(1, 4, [&](int shard) { order.push_back(shard); });
+  EXPECT_THAT(order, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(ParallelForTest, EveryShardRunsOnce) {
+  std::vector<int> counts(100, 0);
+  ParallelFor(8, counts.size(), [&](int shard) { counts[shard]++; });
+  EXPECT_THAT(counts, Each(Eq(1)));
+}
+
+TEST(ParallelForTest, MoreThreadsThanShards) {
+  std::vector<int> counts(2, 0);
+  ParallelFor(16, counts.size(), [&](int shard) { counts[shard]++; });
+  EXPECT_THAT(counts, ElementsAre(1, 1));
+}
+
+TEST(ThreadPoolTest, SingleThreadRunsInOrder) {
+  ThreadPool pool(1);
+  std::vector<int> order;
+  ParallelFor(&pool, 4, [&](int shard) { order.push_back(shard); });
+  EXPECT_THAT(order, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(ThreadPoolTest, ReusedAcrossRuns) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int run = 0; run < 200; run++) {
+    std::vector<int> counts(run % 13, 0);
+    ParallelFor(&pool, counts.size(), [&](int shard) { counts[shard]++; });
+    EXPECT_THAT(counts, Each(Eq(1)));
+  }
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
@@ -0,0 +1,236 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/sorted_costs.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "math_opt_benchmark/facility/parallel_for.h"
+#include "ortools/base/logging.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+constexpr int kCustomersPerShard = 256;
+
+// Identifies the cache file layout: the header, then the sorted costs, then
+// the indices, all in native byte order.
+constexpr uint64_t kCacheMagic = 0x31544f5354534f43;  // "COSTSOT1"
+
+struct CacheHeader {
+  uint64_t magic;
+  uint64_t hash;
+  int32_t num_rows;
+  int32_t num_cols;
+  int32_t index_bytes;
+  int32_t padding;
+};
+
+uint64_t Mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+uint64_t HashRow(absl::Span<const double> row) {
+  uint64_t hash = row.size();
+  for (const double value : row) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    hash = Mix(hash ^ bits);
+  }
+  return hash;
+}
+
+template <typename Index>
+void SortRows(DenseMatrix<double>& costs, DenseMatrix<Index>& indices,
+              int num_threads) {
+  const int num_rows = costs.num_rows();
+  const int num_shards = (num_rows + kCustomersPerShard - 1) / kCustomersPerShard;
+  ParallelFor(num_threads, num_shards, [&](int shard) {
+    std::vector<double> gathered(costs.num_cols());
+    const int end = std::min(num_rows, (shard + 1) * kCustomersPerShard);
+    for (int i = shard * kCustomersPerShard; i < end; i++) {
+      const absl::Span<double> row = costs[i];
+      const absl::Span<Index> order = indices[i];
+      std::iota(order.begin(), order.end(), Index{0});
+      std::sort(order.begin(), order.end(), [&row](Index a, Index b) {
+        return row[a] < row[b] || (row[a] == row[b] && a < b);
+      });
+      for (int j = 0; j < order.size(); j++) {
+        gathered[j] = row[order[j]];
+      }
+      std::copy(gathered.begin(), gathered.end(), row.begin());
+    }
+  });
+}
+
+template <typename T>
+void ReadValues(std::ifstream& input, DenseMatrix<T>& matrix) {
+  input.read(reinterpret_cast<char*>(matrix.values().data()),
+             matrix.size() * sizeof(T));
+}
+
+std::string CachePath(const std::string& cache_dir, uint64_t hash) {
+  return absl::StrCat(cache_dir, cache_dir.empty() || cache_dir.back() == '/'
+                                     ? ""
+                                     : "/",
+                      absl::StrFormat("ufl_sorted_costs_%016x.bin", hash));
+}
+
+}  // namespace
+
+// Fills FacilityOrder's private members for the functions below
+class FacilityOrderBuilder {
+ public:
+  static FacilityOrder Sort(DenseMatrix<double>& costs, int num_threads) {
+    FacilityOrder order(costs.num_rows(), costs.num_cols());
+    if (order.narrow_) {
+      SortRows(costs, order.narrow_indices_, num_threads);
+    } else {
+      SortRows(costs, order.wide_indices_, num_threads);
+    }
+    return order;
+  }
+
+  static bool Load(const std::string& path, uint64_t hash,
+                   DenseMatrix<double>& costs, FacilityOrder& order) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) {
+      return false;
+    }
+    order = FacilityOrder(costs.num_rows(), costs.num_cols());
+    CacheHeader header;
+    input.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!input || header.magic != kCacheMagic || header.hash != hash ||
+        header.num_rows != costs.num_rows() ||
+        header.num_cols != costs.num_cols() ||
+        header.index_bytes != IndexBytes(order)) {
+      LOG(WARNING) << "Ignoring stale sorted costs cache " << path;
+      return false;
+    }
+    DenseMatrix<double> sorted(costs.num_rows(), costs.num_cols());
+    ReadValues(input, sorted);
+    if (order.narrow_) {
+      ReadValues(input, order.narrow_indices_);
+    } else {
+      ReadValues(input, order.wide_indices_);
+    }
+    if (!input) {
+      LOG(WARNING) << "Truncated sorted costs cache " << path;
+      return false;
+    }
+    costs = std::move(sorted);
+    return true;
+  }
+
+  static absl::Status Store(const std::string& path, uint64_t hash,
+                            const DenseMatrix<double>& costs,
+                            const FacilityOrder& order) {
+    // Written to a unique temporary file in the same directory and renamed,
+    // so concurrent runs storing the same instance never write to the same
+    // file, and readers never see a partial one
+    std::string temporary = absl::StrCat(path, ".XXXXXX");
+    const int fd = mkstemp(temporary.data());
+    if (fd < 0) {
+      return absl::NotFoundError(
+          absl::StrCat("Could not create a temporary file for ", path));
+    }
+    close(fd);
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+      std::remove(temporary.c_str());
+      return absl::NotFoundError(absl::StrCat("Could not open ", temporary));
+    }
+    const CacheHeader header = {kCacheMagic,      hash, costs.num_rows(),
+                                costs.num_cols(), IndexBytes(order), 0};
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(costs.values().data()),
+                 costs.size() * sizeof(double));
+    order.Visit([&output](const auto& indices) {
+      output.write(reinterpret_cast<const char*>(indices.values().data()),
+                   indices.size() * sizeof(indices.values()[0]));
+    });
+    output.close();
+    if (output.fail() || std::rename(temporary.c_str(), path.c_str()) != 0) {
+      std::remove(temporary.c_str());
+      return absl::DataLossError(absl::StrCat("Failed writing ", path));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  static int IndexBytes(const FacilityOrder& order) {
+    return order.narrow_ ? sizeof(uint16_t) : sizeof(uint32_t);
+  }
+};
+
+FacilityOrder::FacilityOrder(int num_customers, int num_facilities)
+    : narrow_(IsNarrow(num_facilities)) {
+  if (narrow_) {
+    narrow_indices_ = DenseMatrix<uint16_t>(num_customers, num_facilities);
+  } else {
+    wide_indices_ = DenseMatrix<uint32_t>(num_customers, num_facilities);
+  }
+}
+
+FacilityOrder SortCosts(DenseMatrix<double>& costs, int num_threads) {
+  return FacilityOrderBuilder::Sort(costs, num_threads);
+}
+
+FacilityOrder SortCostsCached(DenseMatrix<double>& costs, int num_threads,
+                              const std::string& cache_dir) {
+  const uint64_t hash = HashCosts(costs, num_threads);
+  const std::string path = CachePath(cache_dir, hash);
+  FacilityOrder order;
+  if (FacilityOrderBuilder::Load(path, hash, costs, order)) {
+    return order;
+  }
+  order = SortCosts(costs, num_threads);
+  const absl::Status stored =
+      FacilityOrderBuilder::Store(path, hash, costs, order);
+  LOG_IF(WARNING, !stored.ok()) << stored;
+  return order;
+}
+
+uint64_t HashCosts(const DenseMatrix<double>& costs, int num_threads) {
+  std::vector<uint64_t> row_hashes(costs.num_rows());
+  const int num_shards =
+      (costs.num_rows() + kCustomersPerShard - 1) / kCustomersPerShard;
+  ParallelFor(num_threads, num_shards, [&](int shard) {
+    const int end = std::min(costs.num_rows(), (shard + 1) * kCustomersPerShard);
+    for (int i = shard * kCustomersPerShard; i < end; i++) {
+      row_hashes[i] = HashRow(costs[i]);
+    }
+  });
+  // Combined in order so the hash does not depend on the thread count
+  uint64_t hash = Mix(costs.num_rows()) ^ costs.num_cols();
+  for (const uint64_t row_hash : row_hashes) {
+    hash = Mix(hash ^ row_hash);
+  }
+  return hash;
+}
+
+}  // namespace math_opt_benchmark
@@ -0,0 +1,83 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MATH_OPT_BENCHMARK_FACILITY_SORTED_COSTS_H_
+#define MATH_OPT_BENCHMARK_FACILITY_SORTED_COSTS_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "absl/status/status.h"
+#include "math_opt_benchmark/facility/dense_matrix.h"
+
+namespace math_opt_benchmark {
+
+// The facilities of every customer in increasing supply cost order.
+//
+// Indices are stored as uint16_t when there are few enough facilities, which
+// halves the memory traffic of the cut generation loops that stream through
+// them, and as uint32_t otherwise.
+class FacilityOrder {
+ public:
+  FacilityOrder() = default;
+  FacilityOrder(int num_customers, int num_facilities);
+
+  static bool IsNarrow(int num_facilities) {
+    return num_facilities <= std::numeric_limits<uint16_t>::max() + 1;
+  }
+  bool narrow() const { return narrow_; }
+
+  // Calls fn with the index matrix, row i holding the facilities of customer i
+  // from cheapest to most expensive.
+  template <typename Fn>
+  void Visit(const Fn& fn) const {
+    if (narrow_) {
+      fn(narrow_indices_);
+    } else {
+      fn(wide_indices_);
+    }
+  }
+
+  // The facility with the j-th cheapest supply cost to customer i
+  int facility(int i, int j) const {
+    return narrow_ ? narrow_indices_[i][j] : wide_indices_[i][j];
+  }
+
+ private:
+  friend class FacilityOrderBuilder;
+
+  bool narrow_ = true;
+  DenseMatrix<uint16_t> narrow_indices_;
+  DenseMatrix<uint32_t> wide_indices_;
+};
+
+// Sorts every row of `costs` in place, argsorting the row and then gathering
+// it through the permutation, with customers spread over num_threads threads.
+// Ties keep the lower facility first.
+FacilityOrder SortCosts(DenseMatrix<double>& costs, int num_threads);
+
+// As SortCosts, but first looks the result up in `cache_dir` under a hash of
+// `costs` and stores it there on a miss, so repeated runs on an instance skip
+// the sort. Cache errors are logged and fall back to sorting.
+FacilityOrder SortCostsCached(DenseMatrix<double>& costs, int num_threads,
+                              const std::string& cache_dir);
+
+// Hash of the dimensions and entries of `costs`, stable across runs and
+// platforms with the same byte order.
+uint64_t HashCosts(const DenseMatrix<double>& costs, int num_threads);
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_FACILITY_SORTED_COSTS_H_
@@ -0,0 +1,147 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/sorted_costs.h"
+
+#include <sys/stat.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+std::vector<int> Order(const FacilityOrder& order, int i, int num_facilities) {
+  std::vector<int> facilities;
+  for (int j = 0; j < num_facilities; j++) {
+    facilities.push_back(order.facility(i, j));
+  }
+  return facilities;
+}
+
+// Costs that are not sorted and have ties, with enough customers to span
+// several shards.
+DenseMatrix<double> MakeCosts(int num_customers, int num_facilities) {
+  DenseMatrix<double> costs(num_customers, num_facilities);
+  for (int i = 0; i < num_customers; i++) {
+    for (int j = 0; j < num_facilities; j++) {
+      costs[i][j] = (i * 7 + j * 13) % 11;
+    }
+  }
+  return costs;
+}
+
+TEST(SortCostsTest, SortsRowsAndBreaksTiesByFacility) {
+  DenseMatrix<double> costs = {{3, 1, 2, 1}, {0, 5, 0, 4}};
+  const FacilityOrder order = SortCosts(costs, 1);
+  EXPECT_TRUE(order.narrow());
+  EXPECT_THAT(costs[0], ElementsAre(1, 1, 2, 3));
+  EXPECT_THAT(costs[1], ElementsAre(0, 0, 4, 5));
+  EXPECT_THAT(Order(order, 0, 4), ElementsAre(1, 3, 2, 0));
+  EXPECT_THAT(Order(order, 1, 4), ElementsAre(0, 2, 3, 1));
+}
+
+TEST(SortCostsTest, WideIndices) {
+  const int num_facilities = 70000;
+  EXPECT_FALSE(FacilityOrder::IsNarrow(num_facilities));
+  DenseMatrix<double> costs(1, num_facilities);
+  for (int j = 0; j < num_facilities; j++) {
+    costs[0][j] = num_facilities - j;
+  }
+  const FacilityOrder order = SortCosts(costs, 1);
+  EXPECT_FALSE(order.narrow());
+  EXPECT_EQ(order.facility(0, 0), num_facilities - 1);
+  EXPECT_EQ(order.facility(0, num_facilities - 1), 0);
+  EXPECT_EQ(costs[0][0], 1);
+}
+
+TEST(SortCostsTest, ThreadsDoNotChangeResult) {
+  DenseMatrix<double> serial_costs = MakeCosts(1000, 9);
+  DenseMatrix<double> parallel_costs = serial_costs;
+  const FacilityOrder serial = SortCosts(serial_costs, 1);
+  const FacilityOrder parallel = SortCosts(parallel_costs, 4);
+  EXPECT_THAT(parallel_costs.values(), ElementsAreArray(serial_costs.values()));
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(Order(parallel, i, 9), Order(serial, i, 9));
+  }
+}
+
+TEST(HashCostsTest, DependsOnValuesAndShape) {
+  const DenseMatrix<double> costs = MakeCosts(600, 5);
+  EXPECT_EQ(HashCosts(costs, 1), HashCosts(costs, 4));
+  DenseMatrix<double> changed = costs;
+  changed[599][4] += 0.5;
+  EXPECT_NE(HashCosts(changed, 1), HashCosts(costs, 1));
+  EXPECT_NE(HashCosts(DenseMatrix<double>(2, 3), 1),
+            HashCosts(DenseMatrix<double>(3, 2), 1));
+}
+
+TEST(SortCostsCachedTest, ReusesStoredResult) {
+  const std::string dir = ::testing::TempDir() + "/sorted_costs_cache";
+  mkdir(dir.c_str(), 0755);
+  DenseMatrix<double> expected_costs = MakeCosts(300, 6);
+  const FacilityOrder expected = SortCosts(expected_costs, 1);
+
+  DenseMatrix<double> stored_costs = MakeCosts(300, 6);
+  SortCostsCached(stored_costs, 2, dir);
+  DenseMatrix<double> loaded_costs = MakeCosts(300, 6);
+  const FacilityOrder loaded = SortCostsCached(loaded_costs, 2, dir);
+  EXPECT_THAT(loaded_costs.values(), ElementsAreArray(expected_costs.values()));
+  for (int i = 0; i < 300; i++) {
+    EXPECT_EQ(Order(loaded, i, 6), Order(expected, i, 6));
+  }
+}
+
+TEST(SortCostsCachedTest, ConcurrentStoresLeaveAValidCache) {
+  const std::string dir = ::testing::TempDir() + "/sorted_costs_concurrent";
+  mkdir(dir.c_str(), 0755);
+  DenseMatrix<double> expected_costs = MakeCosts(500, 7);
+  const FacilityOrder expected = SortCosts(expected_costs, 1);
+
+  // Every thread misses the cache and stores the same instance
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&dir]() {
+      DenseMatrix<double> costs = MakeCosts(500, 7);
+      SortCostsCached(costs, 1, dir);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  DenseMatrix<double> loaded_costs = MakeCosts(500, 7);
+  const FacilityOrder loaded = SortCostsCached(loaded_costs, 1, dir);
+  EXPECT_THAT(loaded_costs.values(), ElementsAreArray(expected_costs.values()));
+  for (int i = 0; i < 500; i++) {
+    EXPECT_EQ(Order(loaded, i, 7), Order(expected, i, 7));
+  }
+}
+
+TEST(SortCostsCachedTest, MissingDirectoryFallsBackToSorting) {
+  DenseMatrix<double> costs = {{2, 1}};
+  const FacilityOrder order =
+      SortCostsCached(costs, 1, ::testing::TempDir() + "/missing/dir");
+  EXPECT_THAT(costs[0], ElementsAre(1, 2));
+  EXPECT_EQ(order.facility(0, 0), 1);
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
@@ -15,9 +15,38 @@
 
 #include "math_opt_benchmark/facility/ufl.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/charconv.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "math_opt_benchmark/facility/parallel_for.h"
 #include "ortools/base/logging.h"  // status.h
+#include "ortools/base/status_macros.h"
 
 constexpr double kInf = std::numeric_limits<double>::infinity();
 namespace math_opt = operations_research::math_opt;
@@ -26,78 +55,191 @@ constexpr double kTolerance = 1e-5;
 
 namespace math_opt_benchmark {
 
+SparseBendersCut SparsifyCut(const BendersCut& cut) {
+  SparseBendersCut sparse;
+  sparse.group = cut.group;
+  sparse.sum = cut.sum;
+  for (int i = 0; i < cut.y_coefficients.size(); i++) {
+    if (cut.y_coefficients[i] != 0.0) {
+      sparse.indices.push_back(i);
+      sparse.y_coefficients.push_back(cut.y_coefficients[i]);
+    }
+  }
+  return sparse;
+}
+
+//
+// BendersCutPool
+//
+
+bool BendersCutPool::IsRedundant(const SparseBendersCut& cut) const {
+  for (const PooledCut& pooled : cuts_) {
+    const SparseBendersCut& other = pooled.cut;
+    if (other.group != cut.group || other.sum < cut.sum - kTolerance) {
+      continue;
+    }
+    // Compare coefficient-wise, a missing index having coefficient 0
+    bool dominates = true;
+    int a = 0;
+    int b = 0;
+    while (dominates &&
+           (a < other.indices.size() || b < cut.indices.size())) {
+      const int i = a < other.indices.size() ? other.indices[a] : INT_MAX;
+      const int j = b < cut.indices.size() ? cut.indices[b] : INT_MAX;
+      const double other_coefficient = i <= j ? other.y_coefficients[a] : 0.0;
+      const double coefficient = j <= i ? cut.y_coefficients[b] : 0.0;
+      dominates = other_coefficient <= coefficient + kTolerance;
+      a += i <= j;
+      b += j <= i;
+    }
+    if (dominates) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BendersCutPool::Add(SparseBendersCut cut,
+                         math_opt::LinearConstraint constraint) {
+  cuts_.push_back({std::move(cut), constraint});
+}
+
+void BendersCutPool::UpdateSlacks(const UFLSolution& solution) {
+  for (PooledCut& pooled : cuts_) {
+    const SparseBendersCut& cut = pooled.cut;
+    double slack = solution.bender_values[cut.group] - cut.sum;
+    for (int k = 0; k < cut.indices.size(); k++) {
+      slack += cut.y_coefficients[k] * solution.open_values[cut.indices[k]];
+    }
+    if (slack > kTolerance) {
+      pooled.inactive_rounds++;
+    } else {
+      pooled.inactive_rounds = 0;
+    }
+  }
+}
+
+std::vector<math_opt::LinearConstraint> BendersCutPool::PurgeInactive() {
+  std::vector<math_opt::LinearConstraint> purged;
+  if (max_inactive_rounds_ <= 0) {
+    return purged;
+  }
+  const auto stale = [this](const PooledCut& pooled) {
+    return pooled.inactive_rounds >= max_inactive_rounds_;
+  };
+  for (const PooledCut& pooled : cuts_) {
+    if (stale(pooled)) {
+      purged.push_back(pooled.constraint);
+    }
+  }
+  cuts_.erase(std::remove_if(cuts_.begin(), cuts_.end(), stale), cuts_.end());
+  return purged;
+}
+
 //
 // UFLSolver
 //
 
+namespace {
+
+// MathOpt rejects branching priorities for the other solvers
+bool SupportsBranchingPriorities(math_opt::SolverType solver_type) {
+  return solver_type == math_opt::SolverType::kGurobi ||
+         solver_type == math_opt::SolverType::kGscip;
+}
+
+}  // namespace
+
 /**
  * @param solver_type Which solver to use
  * @param problem Facility location specification with costs and sizes
  */
 UFLSolver::UFLSolver(math_opt::SolverType solver_type,
-                     const UFLProblem& problem, bool iterative = true)
-    : model_("UFL Solver"),
-      bender_var_(model_.AddContinuousVariable(0.0, kInf, "w")),
-      iterative_(iterative) {
-  solver_ =
-      math_opt::NewIncrementalSolver(
-          model_,
-          solver_type)
-          .value();
-  update_tracker_ = model_.NewUpdateTracker();
-  model_.set_minimize();
-  supply_vars_.reserve(problem.num_customers);
-  bool integer = !iterative;
-  for (int i = 0; i < problem.num_customers; ++i) {
-    supply_vars_.emplace_back();
-    supply_vars_[i].reserve(problem.num_facilities);
+                     const UFLProblem& problem, bool iterative = true,
+                     const UFLSolverOptions& options)
+    : recorder_(options.recorder != nullptr ? options.recorder
+                                            : &instance_recorder_),
+      iterative_(iterative),
+      options_(options),
+      cut_pool_(options.max_inactive_rounds) {
+  const bool names = options.variable_names;
+  math_opt::ModelProto initial_model;
+  if (iterative) {
+    // The Benders master only estimates the supply cost through the epigraph
+    // variables w, it is small enough to build one call at a time
+    model_ = std::make_unique<math_opt::Model>("UFL Solver");
+    model_->set_minimize();
+    open_vars_.reserve(problem.num_facilities);
     for (int j = 0; j < problem.num_facilities; ++j) {
-      math_opt::Variable var = model_.AddContinuousVariable(0.0, 1.0, absl::StrCat("x", i, ",", j));
-      supply_vars_[i].push_back(var);
+      math_opt::Variable var = model_->AddContinuousVariable(
+          0.0, 1.0, names ? absl::StrCat("y", j) : std::string());
+      open_vars_.push_back(var);
+      model_->set_objective_coefficient(var, problem.open_costs[j]);
     }
-  }
-
-  open_vars_.reserve(problem.num_facilities);
-  for (int i = 0; i < problem.num_facilities; ++i) {
-    math_opt::Variable var = model_.AddVariable(0.0, 1.0, integer, absl::StrCat("y", i));
-    open_vars_.push_back(var);
-    model_.set_objective_coefficient(var, problem.open_costs[i]);
-  }
-  // Feasibility constraint: at least one facility open
-  const math_opt::LinearConstraint feasible = model_.AddLinearConstraint(1, kInf);
-  for (int i = 0; i < problem.num_facilities; ++i) {
-    model_.set_coefficient(feasible, open_vars_[i], 1);
-  }
-
-  model_.set_objective_coefficient(bender_var_, 1);
-
-  // Regular problem formulation
-  if (!iterative) {
-    // Minimize customer costs
-    for (int i = 0; i < problem.num_customers; ++i) {
-      for (int j = 0; j < problem.num_facilities; ++j) {
-        model_.set_objective_coefficient(supply_vars_[i][j], problem.supply_costs[i][j]);
+    // Feasibility constraint: at least one facility open
+    const math_opt::LinearConstraint feasible =
+        model_->AddLinearConstraint(1, kInf);
+    for (int j = 0; j < problem.num_facilities; ++j) {
+      model_->set_coefficient(feasible, open_vars_[j], 1);
+    }
+    const int num_bender_vars = options.num_bender_vars;
+    CHECK_GE(num_bender_vars, 1);
+    bender_vars_.reserve(num_bender_vars);
+    for (int g = 0; g < num_bender_vars; g++) {
+      std::string name;
+      if (names) {
+        name = num_bender_vars == 1 ? "w" : absl::StrCat("w", g);
       }
+      math_opt::Variable w = model_->AddContinuousVariable(0.0, kInf, name);
+      bender_vars_.push_back(w);
+      model_->set_objective_coefficient(w, 1);
     }
-
-    for (int i = 0; i < problem.num_facilities; ++i) {
-      math_opt::LinearConstraint c = model_.AddLinearConstraint(0, 1);
-      model_.set_coefficient(c, open_vars_[i], 1);
+    initial_model = model_->ExportModel();
+  } else {
+    initial_model =
+        BuildDirectModelProto(problem, names, options.lazy_links);
+    model_ = math_opt::Model::FromModelProto(initial_model).value();
+    // Variables are numbered y first, then x in customer-major order
+    const std::vector<math_opt::Variable> variables =
+        model_->SortedVariables();
+    const int m = problem.num_facilities;
+    open_vars_.assign(variables.begin(), variables.begin() + m);
+    supply_vars_.reserve(problem.num_customers);
+    for (int i = 0; i < problem.num_customers; ++i) {
+      const auto row = variables.begin() + m + static_cast<int64_t>(i) * m;
+      supply_vars_.emplace_back(row, row + m);
     }
+  }
+  initial_model_size_.num_variables = initial_model.variables().ids_size();
+  initial_model_size_.num_constraints =
+      initial_model.linear_constraints().ids_size();
+  initial_model_size_.num_nonzeros =
+      initial_model.linear_constraint_matrix().coefficients_size();
+  initial_model_size_.bytes = initial_model.ByteSizeLong();
 
-    for (int i = 0; i < problem.num_customers; ++i) {
-      // Each customer is fulfilled
-      math_opt::LinearConstraint full = model_.AddLinearConstraint(1, 1);
-      for (int j = 0; j < problem.num_facilities; ++j) {
-        model_.set_coefficient(full, supply_vars_[i][j], 1);
-        // Only supplied by open facilities
-        math_opt::LinearConstraint open = model_.AddLinearConstraint(-kInf, 0);
-        model_.set_coefficient(open, supply_vars_[i][j], 1);
-        model_.set_coefficient(open, open_vars_[j], -1);
-      }
+  std::vector<math_opt::SolverType> solver_types = {solver_type};
+  for (const math_opt::SolverType type : options.portfolio) {
+    if (std::find(solver_types.begin(), solver_types.end(), type) ==
+        solver_types.end()) {
+      solver_types.push_back(type);
+    }
+  }
+  for (const math_opt::SolverType type : solver_types) {
+    absl::StatusOr<std::unique_ptr<math_opt::IncrementalSolver>> solver =
+        math_opt::NewIncrementalSolver(*model_, type);
+    if (!solver.ok() && !options.portfolio.empty()) {
+      LOG(WARNING) << "Skipping " << math_opt::EnumToString(type)
+                   << " in the portfolio: " << solver.status();
+      continue;
     }
+    CHECK_OK(solver.status());
+    backends_.push_back({type, *std::move(solver)});
   }
-  *(instance_.mutable_initial_model()) = model_.ExportModel();
+  CHECK(!backends_.empty()) << "No solver of the portfolio is available";
+  last_solve_stats_.solver = backends_[0].type;
+  update_tracker_ = model_->NewUpdateTracker();
+  recorder_->SetInitialModel(initial_model);
+  update_tracker_->Checkpoint();
 }
 
 /**
@@ -105,18 +247,161 @@ UFLSolver::UFLSolver(math_opt::SolverType solver_type,
  * @return Solution containing objective value and variable values
  */
 UFLSolution UFLSolver::Solve() {
+  if (!iterative_ && options_.lazy_links) {
+    return SolveWithLazyLinks();
+  }
+  math_opt::SolveArguments solve_args;
+  return SolveWithArguments(solve_args);
+}
+
+UFLSolution UFLSolver::SolveWithLazyCuts(const BendersSeparator& separator,
+                                         bool separate_fractional) {
   math_opt::SolveArguments solve_args;
-  absl::StatusOr<math_opt::SolveResult> result = solver_->Solve(solve_args);
-  CHECK_EQ(result.value().termination.reason, math_opt::TerminationReason::kOptimal) << result.value().termination.detail;
+  solve_args.callback_registration.add_lazy_constraints = true;
+  solve_args.callback_registration.events.insert(
+      math_opt::CallbackEvent::kMipSolution);
+  if (separate_fractional) {
+    solve_args.callback_registration.events.insert(
+        math_opt::CallbackEvent::kMipNode);
+  }
+  absl::Mutex mutex;
+  std::vector<BendersCut> lazy_cuts;
+  solve_args.callback = [&](const math_opt::CallbackData& data) {
+    math_opt::CallbackResult result;
+    // Nodes without an optimal LP relaxation have no solution
+    if (!data.solution.has_value()) {
+      return result;
+    }
+    UFLSolution candidate;
+    candidate.open_values.reserve(open_vars_.size());
+    for (math_opt::Variable v : open_vars_) {
+      candidate.open_values.push_back(data.solution->at(v));
+    }
+    candidate.bender_values.reserve(bender_vars_.size());
+    for (math_opt::Variable w : bender_vars_) {
+      candidate.bender_values.push_back(data.solution->at(w));
+    }
+    std::vector<BendersCut> cuts = separator(candidate);
+    for (const BendersCut& cut : cuts) {
+      result.AddLazyConstraint(CutExpression(cut) >= cut.sum);
+    }
+    absl::MutexLock lock(&mutex);
+    lazy_cuts.insert(lazy_cuts.end(), std::make_move_iterator(cuts.begin()),
+                     std::make_move_iterator(cuts.end()));
+    return result;
+  };
+  return SolveWithArguments(solve_args, nullptr, &lazy_cuts);
+}
+
+UFLSolution UFLSolver::SolveWithLazyLinks() {
+  DenseMatrix<double> supply_fractions(supply_vars_.size(), open_vars_.size());
+  UFLSolution relaxed;
+  do {
+    relaxed = SolveWithArguments(math_opt::SolveArguments(), &supply_fractions);
+  } while (relaxed.status == UFLSolveStatus::kOptimal &&
+           AddViolatedLinks(relaxed.open_values, supply_fractions) > 0);
+  // The aggregated links are already exact for integer y, the added ones only
+  // tighten the relaxation
+  EnforceInteger();
+  return SolveWithArguments(math_opt::SolveArguments());
+}
+
+int UFLSolver::AddViolatedLinks(const std::vector<double>& open_values,
+                                const DenseMatrix<double>& supply_fractions) {
+  int num_added = 0;
+  for (int i = 0; i < supply_fractions.num_rows(); i++) {
+    const absl::Span<const double> fractions = supply_fractions[i];
+    for (int j = 0; j < fractions.size(); j++) {
+      if (fractions[j] > open_values[j] + kTolerance) {
+        const math_opt::LinearConstraint link =
+            model_->AddLinearConstraint(-kInf, 0);
+        model_->set_coefficient(link, supply_vars_[i][j], 1);
+        model_->set_coefficient(link, open_vars_[j], -1);
+        num_added++;
+      }
+    }
+  }
+  num_lazy_links_ += num_added;
+  return num_added;
+}
+
+UFLSolution UFLSolver::SolveWithArguments(
+    math_opt::SolveArguments solve_args, DenseMatrix<double>* supply_fractions,
+    const std::vector<BendersCut>* lazy_cuts) {
+  last_solve_stats_.export_time = absl::ZeroDuration();
+  last_solve_recorded_ = false;
+  if (limits_.deadline != absl::InfiniteFuture()) {
+    solve_args.parameters.time_limit =
+        std::max(limits_.deadline - absl::Now(), absl::ZeroDuration());
+  }
+  if (limits_.relative_gap > 0) {
+    solve_args.parameters.relative_gap_limit = limits_.relative_gap;
+  }
+  const absl::Time solve_start = absl::Now();
+  absl::StatusOr<math_opt::SolveResult> result = RaceSolve(solve_args);
+  last_solve_stats_.solve_time = absl::Now() - solve_start;
+  CHECK_OK(result.status());
+
+  last_solve_stats_.simplex_iterations =
+      result.value().solve_stats.simplex_iterations;
+  last_solve_stats_.node_count = result.value().solve_stats.node_count;
+  if (lazy_cuts != nullptr) {
+    // The solution only satisfies the master with the lazy cuts, so they join
+    // the model and the recorded update replays to the same optimum
+    for (const BendersCut& cut : *lazy_cuts) {
+      AddCutConstraint(SparsifyCut(cut));
+    }
+  }
 
   UFLSolution solution;
+  const math_opt::TerminationReason reason = result.value().termination.reason;
+  // Limits can only stop a solve early, any other outcome is a modeling error
+  CHECK(reason == math_opt::TerminationReason::kOptimal ||
+        reason == math_opt::TerminationReason::kFeasible ||
+        reason == math_opt::TerminationReason::kNoSolutionFound)
+      << result.value().termination;
+  const double dual_bound = result.value().solve_stats.best_dual_bound;
+  if (reason == math_opt::TerminationReason::kNoSolutionFound) {
+    CHECK(limits_.deadline != absl::InfiniteFuture())
+        << result.value().termination;
+    solution.objective_value = kInf;
+    solution.status = UFLSolveStatus::kTimeLimit;
+    solution.lower_bound = dual_bound;
+    // There is no objective a replay could match, so the solve is not recorded
+    // and the changes stay pending in the tracker
+    return solution;
+  }
   solution.objective_value = result.value().objective_value();
+  solution.lower_bound = solution.objective_value;
+  if (reason == math_opt::TerminationReason::kFeasible) {
+    CHECK(limits_.deadline != absl::InfiniteFuture())
+        << result.value().termination;
+    solution.status = UFLSolveStatus::kTimeLimit;
+    solution.lower_bound = dual_bound;
+  } else if (limits_.relative_gap > 0 && std::isfinite(dual_bound) &&
+             dual_bound < solution.objective_value - kTolerance) {
+    solution.status = UFLSolveStatus::kGapLimit;
+    solution.lower_bound = dual_bound;
+  }
   solution.open_values.reserve(open_vars_.size());
   for (math_opt::Variable v : open_vars_) {
     solution.open_values.push_back(result.value().variable_values().at(v));
   }
 
-  if (!iterative_) {
+  if (iterative_) {
+    solution.bender_values.reserve(bender_vars_.size());
+    for (math_opt::Variable w : bender_vars_) {
+      solution.bender_values.push_back(result.value().variable_values().at(w));
+    }
+  } else {
+    if (supply_fractions != nullptr) {
+      for (int i = 0; i < supply_vars_.size(); i++) {
+        absl::Span<double> row = (*supply_fractions)[i];
+        for (int j = 0; j < row.size(); j++) {
+          row[j] = result.value().variable_values().at(supply_vars_[i][j]);
+        }
+      }
+    }
     for (int i = 0; i < supply_vars_.size(); i++) {
       for (int j = 0; j < supply_vars_[0].size(); j++) {
         if (result.value().variable_values().at(supply_vars_[i][j]) > 0.5) {
@@ -127,105 +412,1012 @@ UFLSolution UFLSolver::Solve() {
     }
   }
 
-  instance_.add_objectives(solution.objective_value);
+  if (iterative_) {
+    last_open_values_ = solution.open_values;
+    last_bender_values_ = solution.bender_values;
+  }
+  if (options_.max_inactive_rounds > 0) {
+    cut_pool_.UpdateSlacks(solution);
+  }
+  const absl::Time export_start = absl::Now();
+  RecordSolve(solution.objective_value);
+  last_solve_stats_.export_time = absl::Now() - export_start;
   return solution;
 }
 
-void UFLSolver::AddBenderCut(double sum, const std::vector<double> &y_coefficients) {
-  // bender_var_ >= sum - \sum_i y_coefficients[i] * y_i
+absl::StatusOr<math_opt::SolveResult> UFLSolver::RaceSolve(
+    const math_opt::SolveArguments& solve_args) {
+  // Callbacks such as lazy cut separation are not safe to call concurrently
+  if (backends_.size() == 1 || solve_args.callback != nullptr) {
+    last_solve_stats_.solver = backends_[0].type;
+    return backends_[0].solver->Solve(
+        SolveArgumentsFor(backends_[0].type, solve_args));
+  }
+  // Synchronize every solver first, the racing solves only read the model
+  const int num_backends = backends_.size();
+  std::vector<absl::StatusOr<math_opt::SolveResult>> results(
+      num_backends, absl::CancelledError("Not solved"));
+  std::vector<bool> synced(num_backends);
+  for (int b = 0; b < num_backends; b++) {
+    const absl::StatusOr<math_opt::UpdateResult> update =
+        backends_[b].solver->Update();
+    synced[b] = update.ok();
+    if (!update.ok()) {
+      results[b] = update.status();
+    }
+  }
+  math_opt::SolveInterrupter interrupter;
+  absl::Mutex mutex;
+  int winner = -1;
+  ParallelFor(num_backends, num_backends, [&](int b) {
+    if (!synced[b]) {
+      return;
+    }
+    math_opt::SolveArguments race_args =
+        SolveArgumentsFor(backends_[b].type, solve_args);
+    race_args.interrupter = &interrupter;
+    absl::StatusOr<math_opt::SolveResult> result =
+        backends_[b].solver->SolveWithoutUpdate(race_args);
+    absl::MutexLock lock(&mutex);
+    if (winner < 0 && result.ok() &&
+        result->termination.reason == math_opt::TerminationReason::kOptimal) {
+      winner = b;
+      interrupter.Interrupt();
+    }
+    results[b] = std::move(result);
+  });
+  // Without an optimal result, e.g. at a time limit, prefer the main solver
+  for (int b = 0; winner < 0 && b < num_backends; b++) {
+    if (results[b].ok()) {
+      winner = b;
+    }
+  }
+  if (winner < 0) {
+    return results[0].status();
+  }
+  last_solve_stats_.solver = backends_[winner].type;
+  absl::StatusOr<math_opt::SolveResult> result = std::move(results[winner]);
+  // Failed solvers are out of sync with the model and stop racing
+  for (int b = num_backends - 1; b >= 0; b--) {
+    if (!results[b].ok() && b != winner) {
+      LOG(WARNING) << "Dropping " << math_opt::EnumToString(backends_[b].type)
+                   << " from the portfolio: " << results[b].status();
+      backends_.erase(backends_.begin() + b);
+    }
+  }
+  return result;
+}
+
+void UFLSolver::AddBenderCut(double sum, const std::vector<double>& y_coefficients) {
+  BendersCut cut;
+  cut.sum = sum;
+  cut.y_coefficients = y_coefficients;
+  AddBenderCuts({cut});
+}
+
+int UFLSolver::AddBenderCuts(const std::vector<BendersCut>& cuts) {
+  std::vector<SparseBendersCut> sparse_cuts;
+  sparse_cuts.reserve(cuts.size());
+  for (const BendersCut& cut : cuts) {
+    sparse_cuts.push_back(SparsifyCut(cut));
+  }
+  return AddBenderCuts(absl::MakeConstSpan(sparse_cuts));
+}
+
+int UFLSolver::AddBenderCuts(absl::Span<const SparseBendersCut> cuts) {
+  for (const math_opt::LinearConstraint constraint :
+       cut_pool_.PurgeInactive()) {
+    model_->DeleteLinearConstraint(constraint);
+    num_purged_cuts_++;
+  }
+  const bool track_cuts =
+      options_.max_inactive_rounds > 0 || options_.filter_redundant_cuts;
+  int num_added = 0;
+  for (const SparseBendersCut& cut : cuts) {
+    // The dominance test allows a tolerance per coefficient, which can add
+    // up to more than the violation of the master solution
+    if (options_.filter_redundant_cuts && cut_pool_.IsRedundant(cut) &&
+        !CutsOffLastSolution(cut)) {
+      num_rejected_cuts_++;
+      continue;
+    }
+    const math_opt::LinearConstraint constraint = AddCutConstraint(cut);
+    if (track_cuts) {
+      cut_pool_.Add(cut, constraint);
+    }
+    num_added++;
+  }
+  return num_added;
+}
+
+void UFLSolver::RecordSolve(const double objective) {
+  const std::optional<math_opt::ModelUpdateProto> update =
+      update_tracker_->ExportModelUpdate();
+  if (num_recorded_solves_ == 0 && update.has_value()) {
+    // The initial model was only solved without finding a solution. It is
+    // already recorded, so it gets a placeholder objective that replays skip,
+    // and the changes since become the first update.
+    recorder_->AddObjective(std::numeric_limits<double>::quiet_NaN());
+  }
+  if (num_recorded_solves_ > 0 || update.has_value()) {
+    // Record an update before every solve but the first, even if it is empty,
+    // so that objectives(k) is the optimum after model_updates(0..k-1).
+    recorder_->AddModelUpdate(update.has_value() ? *update
+                                                 : math_opt::ModelUpdateProto());
+  }
   update_tracker_->Checkpoint();
+  recorder_->AddObjective(objective);
+  num_recorded_solves_++;
+  last_solve_recorded_ = true;
+}
+
+std::optional<math_opt::ModelUpdateProto> UFLSolver::PendingModelUpdate()
+    const {
+  return update_tracker_->ExportModelUpdate();
+}
 
-  math_opt::LinearConstraint cut = model_.AddLinearConstraint(sum, kInf);
-  model_.set_coefficient(cut, bender_var_, 1);
+void UFLSolver::RecordIteration(const IterationStats& stats) {
+  if (last_solve_recorded_) {
+    recorder_->AddIterationStats(stats);
+  }
+}
+
+math_opt::LinearExpression UFLSolver::CutExpression(
+    const BendersCut& cut) const {
+  math_opt::LinearExpression expression(bender_vars_.at(cut.group));
   for (int i = 0; i < open_vars_.size(); i++) {
-    model_.set_coefficient(cut, open_vars_[i], y_coefficients[i]);
+    if (cut.y_coefficients[i] != 0.0) {
+      expression += cut.y_coefficients[i] * open_vars_[i];
+    }
   }
-  std::optional<math_opt::ModelUpdateProto> update;
-  update = update_tracker_
-               ->ExportModelUpdate() ;
-  if(update.has_value()){
-    *(instance_.add_model_updates()) = *update;
+  return expression;
+}
+
+math_opt::LinearConstraint UFLSolver::AddCutConstraint(
+    const SparseBendersCut& cut) {
+  // bender_vars_[group] >= sum - \sum_k y_coefficients[k] * y_{indices[k]}
+  math_opt::LinearConstraint constraint =
+      model_->AddLinearConstraint(cut.sum, kInf);
+  model_->set_coefficient(constraint, bender_vars_.at(cut.group), 1);
+  for (int k = 0; k < cut.indices.size(); k++) {
+    model_->set_coefficient(constraint, open_vars_.at(cut.indices[k]),
+                            cut.y_coefficients[k]);
   }
+  return constraint;
+}
+
+bool UFLSolver::CutsOffLastSolution(const SparseBendersCut& cut) const {
+  if (last_open_values_.empty()) {
+    return false;
+  }
+  double cost = cut.sum;
+  for (int k = 0; k < cut.indices.size(); k++) {
+    cost -= cut.y_coefficients[k] * last_open_values_[cut.indices[k]];
+  }
+  return cost > last_bender_values_[cut.group] + kTolerance;
 }
 
 void UFLSolver::EnforceInteger() {
   for (math_opt::Variable v : open_vars_) {
-    model_.set_is_integer(v, true);
+    model_->set_is_integer(v, true);
+  }
+}
+
+void UFLSolver::SetOpenBounds(const std::vector<double>& lower,
+                              const std::vector<double>& upper) {
+  CHECK_EQ(lower.size(), open_vars_.size());
+  CHECK_EQ(upper.size(), open_vars_.size());
+  for (int j = 0; j < open_vars_.size(); j++) {
+    const math_opt::Variable v = open_vars_[j];
+    if (v.lower_bound() != lower[j]) {
+      model_->set_lower_bound(v, lower[j]);
+    }
+    if (v.upper_bound() != upper[j]) {
+      model_->set_upper_bound(v, upper[j]);
+    }
+  }
+}
+
+void UFLSolver::SetSolutionHint(const std::vector<double>& open_values) {
+  CHECK_EQ(open_values.size(), open_vars_.size());
+  hint_open_values_ = open_values;
+}
+
+void UFLSolver::SetBranchingPriorities(const std::vector<int>& priorities) {
+  CHECK_EQ(priorities.size(), open_vars_.size());
+  branching_priorities_ = priorities;
+}
+
+math_opt::SolveArguments UFLSolver::SolveArgumentsFor(
+    const math_opt::SolverType solver_type,
+    math_opt::SolveArguments solve_args) const {
+  if (!hint_open_values_.empty()) {
+    math_opt::ModelSolveParameters::SolutionHint hint;
+    for (int i = 0; i < open_vars_.size(); i++) {
+      hint.variable_values[open_vars_[i]] = hint_open_values_[i];
+    }
+    solve_args.model_parameters.solution_hints.push_back(std::move(hint));
+  }
+  if (SupportsBranchingPriorities(solver_type)) {
+    for (int i = 0; i < branching_priorities_.size(); i++) {
+      solve_args.model_parameters.branching_priorities[open_vars_[i]] =
+          branching_priorities_[i];
+    }
   }
+  return solve_args;
 }
 
 BenchmarkInstance UFLSolver::GetModel() {
-  return instance_;
+  return instance_recorder_.instance();
 }
 
 //
 // UFLBenders
 //
 
+namespace {
+
+UFLSolverOptions MasterOptions(const UFLBendersOptions& options,
+                               const UFLProblem& problem) {
+  UFLSolverOptions master = options.master;
+  master.num_bender_vars =
+      std::clamp(options.num_cut_groups, 1, problem.num_customers);
+  return master;
+}
+
+// The subproblem of a customer with costs sorted increasingly has the duals
+// v - sum_j max(0, v - c_j) y_j, a concave function of v. At the master
+// solution y it is maximal for v from c_{k-1}, for the critical index k, up to
+// the cost of the next facility with y_j > 0 if the first k facilities serve
+// exactly the whole demand, and only at c_{k-1} otherwise. Returns the v in
+// that range maximizing the cut at `core_point`: the critical cost at the core
+// point, clamped to the range.
+template <typename Index>
+double ParetoOptimalDual(absl::Span<const double> open_values,
+                         absl::Span<const double> core_point,
+                         absl::Span<const Index> indices,
+                         absl::Span<const double> costs, int k) {
+  const double best = costs[SeparateCustomer(core_point, indices) - 1];
+  if (best <= costs[k - 1]) {
+    return costs[k - 1];
+  }
+  double served = 0.0;
+  for (int j = 0; j < k; j++) {
+    served += open_values[indices[j]];
+  }
+  if (std::abs(served - 1) > kTolerance) {
+    return costs[k - 1];
+  }
+  for (int j = k; j < costs.size() && costs[j] < best; j++) {
+    if (open_values[indices[j]] > kTolerance) {
+      return costs[j];
+    }
+  }
+  return best;
+}
+
+// The dual of one customer, which is the constant term of its cut. Sets
+// `critical_index`, if given, to the customer's critical index.
+template <typename Index>
+double CustomerDual(absl::Span<const double> open_values,
+                    absl::Span<const double> core_point,
+                    absl::Span<const Index> indices,
+                    absl::Span<const double> costs,
+                    int* critical_index = nullptr) {
+  // Don't actually need the knapsack solution, just need the length
+  const int k = SeparateCustomer(open_values, indices);
+  if (critical_index != nullptr) {
+    *critical_index = k;
+  }
+  return core_point.empty()
+             ? costs[k - 1]
+             : ParetoOptimalDual(open_values, core_point, indices, costs, k);
+}
+
+// Adds the cut coefficients of one customer to `y_coefficients` and returns
+// its constant term, see CustomerDual.
+template <typename Index>
+double AddCustomerCut(absl::Span<const double> open_values,
+                      absl::Span<const double> core_point,
+                      absl::Span<const Index> indices,
+                      absl::Span<const double> costs,
+                      absl::Span<double> y_coefficients,
+                      int* critical_index = nullptr) {
+  const double dual =
+      CustomerDual(open_values, core_point, indices, costs, critical_index);
+  for (int j = 0; j < costs.size() && costs[j] < dual; j++) {
+    y_coefficients[indices[j]] += dual - costs[j];
+  }
+  return dual;
+}
+
+// Adds `scale` times the cut of a customer with critical index k to
+// `y_coefficients` and returns `scale` times its constant term. Without a core
+// point the cut only depends on k, so scale -1 removes what AddCustomerCut
+// added.
+template <typename Index>
+double AddCriticalCut(absl::Span<const Index> indices,
+                      absl::Span<const double> costs, int k, double scale,
+                      absl::Span<double> y_coefficients) {
+  const double dual = costs[k - 1];
+  for (int j = 0; j < costs.size() && costs[j] < dual; j++) {
+    y_coefficients[indices[j]] += scale * (dual - costs[j]);
+  }
+  return scale * dual;
+}
+
+// Incremental separations between full ones, which bound the rounding error
+// accumulated by updating the group cuts
+constexpr int kMaxIncrementalRounds = 32;
+
+// Stabilized iterations without progress before falling back to the plain loop
+constexpr int kMaxStalledIterations = 5;
+
+double OpenCost(const UFLProblem& problem,
+                const std::vector<double>& open_values) {
+  double cost = 0.0;
+  for (int i = 0; i < problem.num_facilities; i++) {
+    cost += problem.open_costs[i] * open_values[i];
+  }
+  return cost;
+}
+
+// Whether `cut` cuts off the master solution's estimate of its group
+bool IsViolated(const BendersCut& cut, const UFLSolution& solution) {
+  double cost = cut.sum;
+  for (int i = 0; i < cut.y_coefficients.size(); i++) {
+    cost -= cut.y_coefficients[i] * solution.open_values[i];
+  }
+  return cost > solution.bender_values[cut.group] + kTolerance;
+}
+
+// Average fraction of nonzero y coefficients over `cuts`
+double CutDensity(const std::vector<BendersCut>& cuts) {
+  int64_t num_nonzeros = 0;
+  int64_t num_entries = 0;
+  for (const BendersCut& cut : cuts) {
+    for (const double coefficient : cut.y_coefficients) {
+      num_nonzeros += coefficient != 0.0;
+    }
+    num_entries += cut.y_coefficients.size();
+  }
+  return num_entries > 0 ? static_cast<double>(num_nonzeros) / num_entries
+                         : 0.0;
+}
+
+}  // namespace
+
 UFLBenders::UFLBenders(const UFLProblem& problem,
-                       math_opt::SolverType solver_type)
+                       math_opt::SolverType solver_type,
+                       const UFLBendersOptions& options)
     : problem_(problem),
-      solver_(solver_type, problem, true),
-      cost_indices_(problem.num_customers,
-                    std::vector<int>(problem.num_facilities)) {
-  for (int i = 0; i < problem_.num_customers; i++) {
-    std::vector<double>& costs = problem_.supply_costs[i];
-    std::vector<int>& indices = cost_indices_[i];
-    std::iota(indices.begin(), indices.end(), 0);
-    std::sort(indices.begin(), indices.end(),
-              [&, costs](int i, int j) { return costs[i] < costs[j]; });
-    std::sort(costs.begin(), costs.end());
+      options_(options),
+      solver_(solver_type, problem, true, MasterOptions(options, problem)),
+      pool_(options.num_threads) {
+  CHECK_GT(options_.customers_per_shard, 0);
+  options_.num_cut_groups =
+      std::clamp(options_.num_cut_groups, 1, problem_.num_customers);
+  const absl::Time presort_start = absl::Now();
+  cost_indices_ =
+      options_.presort_cache_dir.empty()
+          ? SortCosts(problem_.supply_costs, options_.num_threads)
+          : SortCostsCached(problem_.supply_costs, options_.num_threads,
+                            options_.presort_cache_dir);
+  stats_.presort_time = absl::Now() - presort_start;
+  if (options_.core_point != CorePoint::kNone) {
+    core_point_.assign(problem_.num_facilities, 0.5);
+    num_core_samples_ = 1;
+  }
+  if (pool_.num_threads() > 1) {
+    const int num_shards =
+        (problem_.num_customers + options_.customers_per_shard - 1) /
+        options_.customers_per_shard;
+    num_column_blocks_ =
+        std::min(problem_.num_facilities, 4 * pool_.num_threads());
+    column_block_ =
+        (problem_.num_facilities + num_column_blocks_ - 1) / num_column_blocks_;
+    customer_duals_.resize(problem_.num_customers);
+    shard_terms_.resize(static_cast<int64_t>(num_shards) * num_column_blocks_);
+  }
+  incremental_ = options_.incremental_separation && core_point_.empty();
+  if (incremental_) {
+    group_coefficients_ =
+        DenseMatrix<double>(options_.num_cut_groups, problem_.num_facilities);
+    group_sums_.resize(options_.num_cut_groups);
+    critical_indices_.resize(problem_.num_customers);
+    facility_customers_.resize(problem_.num_facilities);
+    indexed_positions_.resize(problem_.num_customers);
+    customer_marks_.assign(problem_.num_customers, -1);
   }
 }
 
-UFLSolution UFLBenders::benders() {
+BendersCut UFLBenders::GenerateCut(const std::vector<double>& open_values) {
   const int num_customers = problem_.num_customers;
   const int num_facilities = problem_.num_facilities;
-  std::vector<std::vector<double>>& supply_costs = problem_.supply_costs;
-  UFLSolution solution = solver_.Solve();
-  double best_objective = solution.objective_value;
-  double ub = kInf;
-  while (ub - best_objective >= kTolerance) {
-    std::vector<double> y_coefficients(num_facilities, 0.0);
-    double sum = 0.0;
+  const DenseMatrix<double>& supply_costs = problem_.supply_costs;
+  BendersCut cut;
+  cut.y_coefficients.resize(num_facilities);
+
+  if (pool_.num_threads() == 1) {
+    cost_indices_.Visit([&](const auto& cost_indices) {
+      for (int i = 0; i < num_customers; i++) {
+        cut.sum += AddCustomerCut(
+            open_values, core_point_, cost_indices[i], supply_costs[i],
+            absl::MakeSpan(cut.y_coefficients),
+            incremental_ ? &critical_indices_[i] : nullptr);
+      }
+    });
+  } else {
+    // Shards of customers compute their duals and bucket the coefficient terms
+    // by column block. Each block then adds its terms shard by shard, so every
+    // coefficient, like the sum, is accumulated in customer order and the cut
+    // is bit-identical to the loop above for any thread count and shard size.
+    const int shard_size = options_.customers_per_shard;
+    const int num_blocks = num_column_blocks_;
+    const int num_shards = shard_terms_.size() / num_blocks;
+    ParallelFor(&pool_, num_shards, [&](int shard) {
+      const auto terms = shard_terms_.begin() +
+                         static_cast<int64_t>(shard) * num_blocks;
+      for (int block = 0; block < num_blocks; block++) {
+        terms[block].clear();
+      }
+      const int end = std::min(num_customers, (shard + 1) * shard_size);
+      cost_indices_.Visit([&](const auto& cost_indices) {
+        for (int i = shard * shard_size; i < end; i++) {
+          const auto indices = cost_indices[i];
+          const absl::Span<const double> costs = supply_costs[i];
+          const double dual =
+              CustomerDual(open_values, core_point_, indices, costs,
+                           incremental_ ? &critical_indices_[i] : nullptr);
+          customer_duals_[i] = dual;
+          for (int j = 0; j < costs.size() && costs[j] < dual; j++) {
+            const int facility = indices[j];
+            terms[facility / column_block_].push_back(
+                {facility, dual - costs[j]});
+          }
+        }
+      });
+    });
     for (int i = 0; i < num_customers; i++) {
-      const std::vector<int>& indices = cost_indices_[i];
-      const std::vector<double>& costs = supply_costs[i];
-      std::vector<double> y_solution(num_facilities);
-      for (int j = 0; j < num_facilities; j++) {
-        y_solution[j] = solution.open_values[indices[j]];
+      cut.sum += customer_duals_[i];
+    }
+    ParallelFor(&pool_, num_blocks, [&](int block) {
+      for (int shard = 0; shard < num_shards; shard++) {
+        for (const auto& [facility, term] :
+             shard_terms_[static_cast<int64_t>(shard) * num_blocks + block]) {
+          cut.y_coefficients[facility] += term;
+        }
+      }
+    });
+  }
+  if (incremental_ && options_.num_cut_groups == 1) {
+    absl::c_copy(cut.y_coefficients, group_coefficients_[0].begin());
+    group_sums_[0] = cut.sum;
+    ResetSeparationState(open_values);
+  }
+  return cut;
+}
+
+std::vector<BendersCut> UFLBenders::GenerateGroupCuts(
+    const UFLSolution& solution, double* supply_cost) {
+  const int num_customers = problem_.num_customers;
+  const int num_facilities = problem_.num_facilities;
+  const int num_groups = options_.num_cut_groups;
+  const std::vector<double>& open_values = solution.open_values;
+  const DenseMatrix<double>& supply_costs = problem_.supply_costs;
+
+  std::vector<BendersCut> group_cuts(num_groups);
+  std::vector<double> group_costs(num_groups);
+  ParallelFor(&pool_, num_groups, [&](int group) {
+    BendersCut& cut = group_cuts[group];
+    cut.group = group;
+    cut.y_coefficients.assign(num_facilities, 0.0);
+    const int begin = static_cast<int64_t>(group) * num_customers / num_groups;
+    const int end =
+        static_cast<int64_t>(group + 1) * num_customers / num_groups;
+    cost_indices_.Visit([&](const auto& cost_indices) {
+      for (int i = begin; i < end; i++) {
+        cut.sum += AddCustomerCut(
+            open_values, core_point_, cost_indices[i], supply_costs[i],
+            absl::MakeSpan(cut.y_coefficients),
+            incremental_ ? &critical_indices_[i] : nullptr);
+      }
+    });
+    if (incremental_) {
+      absl::c_copy(cut.y_coefficients, group_coefficients_[group].begin());
+      group_sums_[group] = cut.sum;
+    }
+    double cost = cut.sum;
+    for (int j = 0; j < num_facilities; j++) {
+      cost -= cut.y_coefficients[j] * open_values[j];
+    }
+    group_costs[group] = cost;
+    if (cost <= solution.bender_values[group] + kTolerance) {
+      // Not violated, release the coefficients early
+      cut.y_coefficients = std::vector<double>();
+    }
+  });
+
+  std::vector<BendersCut> cuts;
+  *supply_cost = 0.0;
+  for (int group = 0; group < num_groups; group++) {
+    *supply_cost += group_costs[group];
+    if (!group_cuts[group].y_coefficients.empty()) {
+      cuts.push_back(std::move(group_cuts[group]));
+    }
+  }
+  if (incremental_) {
+    ResetSeparationState(open_values);
+  }
+  return cuts;
+}
+
+std::vector<BendersCut> UFLBenders::Separate(const UFLSolution& solution,
+                                             double* supply_cost) {
+  std::vector<BendersCut> cuts;
+  if (SeparateIncrementally(solution, &cuts, supply_cost)) {
+    return cuts;
+  }
+  if (options_.num_cut_groups > 1) {
+    cuts = GenerateGroupCuts(solution, supply_cost);
+  } else {
+    cuts.push_back(GenerateCut(solution.open_values));
+    const BendersCut& cut = cuts.back();
+    *supply_cost = cut.sum;
+    for (int i = 0; i < problem_.num_facilities; i++) {
+      *supply_cost -= cut.y_coefficients[i] * solution.open_values[i];
+    }
+    if (*supply_cost <= solution.bender_values[0] + kTolerance) {
+      cuts.clear();
+    }
+  }
+  UpdateCorePoint(solution.open_values);
+  return cuts;
+}
+
+bool UFLBenders::SeparateIncrementally(const UFLSolution& solution,
+                                       std::vector<BendersCut>* cuts,
+                                       double* supply_cost) {
+  if (!incremental_ || separated_open_values_.empty() ||
+      num_incremental_rounds_ >= kMaxIncrementalRounds) {
+    return false;
+  }
+  const int num_customers = problem_.num_customers;
+  const int num_facilities = problem_.num_facilities;
+  const int num_groups = options_.num_cut_groups;
+  const std::vector<double>& open_values = solution.open_values;
+  const DenseMatrix<double>& supply_costs = problem_.supply_costs;
+
+  // A customer's critical index only depends on the y of the facilities
+  // before it, so only customers indexed under a changed facility can move
+  num_separations_++;
+  std::vector<int> affected;
+  for (int j = 0; j < num_facilities; j++) {
+    if (open_values[j] == separated_open_values_[j]) {
+      continue;
+    }
+    for (const CustomerPosition& entry : facility_customers_[j]) {
+      const int i = entry.customer;
+      if (entry.position < critical_indices_[i] &&
+          customer_marks_[i] != num_separations_) {
+        customer_marks_[i] = num_separations_;
+        affected.push_back(i);
+      }
+    }
+    if (affected.size() > num_customers / 2) {
+      // Cheaper to separate from scratch, in parallel
+      return false;
+    }
+  }
+
+  cost_indices_.Visit([&](const auto& cost_indices) {
+    for (const int i : affected) {
+      const auto indices = cost_indices[i];
+      const int k = SeparateCustomer(open_values, indices);
+      const int old_k = critical_indices_[i];
+      if (k == old_k) {
+        continue;
       }
-      // Don't actually need the knapsack solution, just need the length
-      const int k = Knapsack(y_solution).size();
-      sum += costs[k - 1];
-      for (int j = 0; j < k - 1; j++) {
-        y_coefficients[indices[j]] += costs[k - 1] - costs[j];
+      // Inverse of the group ranges of GenerateGroupCuts
+      const int group =
+          ((static_cast<int64_t>(i) + 1) * num_groups - 1) / num_customers;
+      const absl::Span<double> y_coefficients = group_coefficients_[group];
+      group_sums_[group] +=
+          AddCriticalCut(indices, supply_costs[i], old_k, -1.0, y_coefficients);
+      group_sums_[group] +=
+          AddCriticalCut(indices, supply_costs[i], k, 1.0, y_coefficients);
+      critical_indices_[i] = k;
+      for (int p = indexed_positions_[i]; p < k; p++) {
+        facility_customers_[indices[p]].push_back({i, p});
       }
+      indexed_positions_[i] = std::max(indexed_positions_[i], k);
+    }
+  });
+
+  *supply_cost = 0.0;
+  for (int group = 0; group < num_groups; group++) {
+    const absl::Span<const double> y_coefficients = group_coefficients_[group];
+    double cost = group_sums_[group];
+    for (int j = 0; j < num_facilities; j++) {
+      cost -= y_coefficients[j] * open_values[j];
+    }
+    *supply_cost += cost;
+    if (cost > solution.bender_values[group] + kTolerance) {
+      BendersCut cut;
+      cut.group = group;
+      cut.sum = group_sums_[group];
+      cut.y_coefficients.assign(y_coefficients.begin(), y_coefficients.end());
+      cuts->push_back(std::move(cut));
+    }
+  }
+  separated_open_values_ = open_values;
+  num_incremental_rounds_++;
+  stats_.num_incremental_separations++;
+  stats_.num_revisited_customers += affected.size();
+  return true;
+}
+
+void UFLBenders::ResetSeparationState(const std::vector<double>& open_values) {
+  separated_open_values_ = open_values;
+  num_incremental_rounds_ = 0;
+  for (std::vector<CustomerPosition>& customers : facility_customers_) {
+    customers.clear();
+  }
+  cost_indices_.Visit([&](const auto& cost_indices) {
+    for (int i = 0; i < problem_.num_customers; i++) {
+      const auto indices = cost_indices[i];
+      for (int p = 0; p < critical_indices_[i]; p++) {
+        facility_customers_[indices[p]].push_back({i, p});
+      }
+      indexed_positions_[i] = critical_indices_[i];
+    }
+  });
+}
+
+void UFLBenders::UpdateCorePoint(const std::vector<double>& open_values) {
+  if (options_.core_point != CorePoint::kAverage) {
+    return;
+  }
+  num_core_samples_++;
+  for (int i = 0; i < problem_.num_facilities; i++) {
+    core_point_[i] += (open_values[i] - core_point_[i]) / num_core_samples_;
+  }
+}
+
+UFLSolution UFLBenders::benders(int* iterations) {
+  const int num_facilities = problem_.num_facilities;
+  UFLSolution solution = solver_.Solve();
+  double best_objective = solution.lower_bound;
+  double ub = kInf;
+  // The separated master solution with cost ub
+  std::vector<double> best_open_values;
+  // The local search is only exact for integer solutions
+  const bool use_heuristic = options_.local_search && integer_phase_;
+  if (use_heuristic && !heuristic_open_values_.empty()) {
+    ub = heuristic_cost_;
+    best_open_values = heuristic_open_values_;
+  }
+  UFLSolveStatus status = UFLSolveStatus::kOptimal;
+  // Set if the last master solution's estimates are its true supply costs
+  bool separated_exactly = false;
+  IterationStats stats = NewIterationStats(best_objective, ub);
+  while (ub - best_objective >= kTolerance) {
+    if (solution.open_values.empty()) {
+      // The master was stopped before finding a solution
+      status = UFLSolveStatus::kTimeLimit;
+      break;
     }
-    double worker_obj = sum;
+    double open_cost = 0.0;
     for (int i = 0; i < num_facilities; i++) {
-      worker_obj -= y_coefficients[i] * solution.open_values[i];
+      open_cost += problem_.open_costs[i] * solution.open_values[i];
+    }
+    double worker_obj;
+    const absl::Time start = absl::Now();
+    const std::vector<BendersCut> cuts = Separate(solution, &worker_obj);
+    stats.set_separation_seconds(absl::ToDoubleSeconds(absl::Now() - start));
+    if (open_cost + worker_obj < ub) {
+      ub = open_cost + worker_obj;
+      best_open_values = solution.open_values;
+    }
+    if (options_.local_search) {
+      RunLocalSearch(solution.open_values);
+      if (heuristic_cost_ < ub) {
+        ub = heuristic_cost_;
+        best_open_values = heuristic_open_values_;
+      }
+    }
+    stats.set_upper_bound(ub);
+    if (cuts.empty()) {
+      // Every estimate is within tolerance of its group's supply cost
+      separated_exactly = true;
+      break;
     }
-    ub = std::min(ub, worker_obj);
-    solver_.AddBenderCut(sum, y_coefficients);
+    if (options_.warm_start && integer_phase_ &&
+        open_cost + worker_obj < incumbent_cost_) {
+      incumbent_ = solution.open_values;
+      incumbent_cost_ = open_cost + worker_obj;
+      solver_.SetSolutionHint(incumbent_);
+    }
+    const int num_added = solver_.AddBenderCuts(cuts);
+    stats.set_num_cuts(num_added);
+    stats.set_cut_density(CutDensity(cuts));
+    if (num_added == 0) {
+      // Every cut is dominated by one in the master, re-solving is a no-op
+      break;
+    }
+    stats_.num_cuts += num_added;
+    if (BudgetExhausted(best_objective, ub, &status)) {
+      break;
+    }
+    RecordIteration(stats);
     solution = solver_.Solve();
-    best_objective = std::max(best_objective, solution.objective_value);
+    ++*iterations;
+    best_objective = std::max(best_objective, solution.lower_bound);
+    stats = NewIterationStats(best_objective, ub);
+  }
+  RecordIteration(stats);
+
+  if (status == UFLSolveStatus::kOptimal) {
+    if (ub - best_objective < kTolerance ||
+        (separated_exactly && solution.status == UFLSolveStatus::kOptimal)) {
+      if (!use_heuristic || best_open_values.empty()) {
+        return solution;
+      }
+      // The incumbent may come from the local search rather than the master
+    } else if (separated_exactly) {
+      // The master solution is exact but was not proven optimal
+      status = solution.status;
+    } else {
+      // Every cut was rejected with the gap still open
+      status = UFLSolveStatus::kStalled;
+    }
+  }
+  UFLSolution best;
+  best.status = status;
+  best.lower_bound = best_objective;
+  best.objective_value = ub;
+  best.open_values = std::move(best_open_values);
+  return best;
+}
+
+void UFLBenders::RunLocalSearch(const std::vector<double>& open_values) {
+  const absl::Time start = absl::Now();
+  LocalSearchResult result =
+      LocalSearch(problem_.open_costs, problem_.supply_costs, cost_indices_,
+                  open_values, options_.num_threads);
+  stats_.local_search_time += absl::Now() - start;
+  if (result.cost < heuristic_cost_) {
+    heuristic_cost_ = result.cost;
+    heuristic_open_values_ = std::move(result.open_values);
+    stats_.num_local_search_incumbents++;
+    if (integer_phase_) {
+      solver_.SetSolutionHint(heuristic_open_values_);
+    }
   }
-  return solution;
+}
+
+bool UFLBenders::BudgetExhausted(double lower_bound, double upper_bound,
+                                 UFLSolveStatus* status) const {
+  if (integer_phase_ && options_.relative_gap > 0 &&
+      upper_bound - lower_bound <=
+          options_.relative_gap * std::abs(upper_bound)) {
+    *status = UFLSolveStatus::kGapLimit;
+    return true;
+  }
+  if (absl::Now() >= phase_deadline_) {
+    *status = UFLSolveStatus::kTimeLimit;
+    return true;
+  }
+  return false;
+}
+
+void UFLBenders::StabilizedBenders(int* iterations) {
+  const int num_facilities = problem_.num_facilities;
+  const bool in_out = options_.stabilization == Stabilization::kInOut;
+  const double alpha = options_.in_out_alpha;
+  const double radius = options_.trust_region_radius;
+  // All open is feasible, the trust region replaces it by the first solution
+  std::vector<double> center(num_facilities, 1.0);
+  double center_cost = kInf;
+  double lb = -kInf;
+  double ub = kInf;
+  int stalled = 0;
+  while (stalled < kMaxStalledIterations && absl::Now() < phase_deadline_) {
+    if (!in_out && center_cost < kInf) {
+      std::vector<double> lower(num_facilities);
+      std::vector<double> upper(num_facilities);
+      for (int i = 0; i < num_facilities; i++) {
+        lower[i] = std::max(0.0, center[i] - radius);
+        upper[i] = std::min(1.0, center[i] + radius);
+      }
+      solver_.SetOpenBounds(lower, upper);
+    }
+    const UFLSolution solution = solver_.Solve();
+    ++*iterations;
+    if (solution.open_values.empty()) {
+      RecordIteration(NewIterationStats(lb, ub));
+      break;
+    }
+    // Only the in-out master is a relaxation of the whole problem
+    const bool improved = solution.objective_value > lb + kTolerance;
+    if (in_out || center_cost == kInf) {
+      lb = std::max(lb, solution.objective_value);
+    }
+    IterationStats stats = NewIterationStats(lb, ub);
+
+    // Every separation point is feasible, so its cost is an upper bound
+    UFLSolution point = solution;
+    if (in_out) {
+      for (int i = 0; i < num_facilities; i++) {
+        point.open_values[i] =
+            alpha * solution.open_values[i] + (1 - alpha) * center[i];
+      }
+    }
+    point.bender_values.assign(solution.bender_values.size(), -kInf);
+    double supply_cost;
+    const absl::Time start = absl::Now();
+    std::vector<BendersCut> cuts = Separate(point, &supply_cost);
+    cuts.erase(std::remove_if(cuts.begin(), cuts.end(),
+                              [&solution](const BendersCut& cut) {
+                                return !IsViolated(cut, solution);
+                              }),
+               cuts.end());
+    stats.set_separation_seconds(absl::ToDoubleSeconds(absl::Now() - start));
+    const double point_cost =
+        OpenCost(problem_, point.open_values) + supply_cost;
+    ub = std::min(ub, point_cost);
+    stats.set_upper_bound(ub);
+
+    bool progress;
+    if (in_out) {
+      progress = improved;
+      for (int i = 0; i < num_facilities; i++) {
+        center[i] = 0.5 * (center[i] + point.open_values[i]);
+      }
+    } else {
+      // Serious step: recenter on a better solution
+      progress = point_cost < center_cost - kTolerance;
+      if (progress) {
+        center = solution.open_values;
+        center_cost = point_cost;
+      }
+    }
+    stalled = progress ? 0 : stalled + 1;
+
+    const int num_added = cuts.empty() ? 0 : solver_.AddBenderCuts(cuts);
+    stats.set_num_cuts(num_added);
+    stats.set_cut_density(CutDensity(cuts));
+    stats_.num_cuts += num_added;
+    RecordIteration(stats);
+    if (num_added == 0) {
+      // Nothing cuts off the master solution, leave the rest to the plain loop
+      break;
+    }
+  }
+  if (!in_out) {
+    solver_.SetOpenBounds(std::vector<double>(num_facilities, 0.0),
+                          std::vector<double>(num_facilities, 1.0));
+  }
+}
+
+IterationStats UFLBenders::NewIterationStats(double lower_bound,
+                                             double upper_bound) const {
+  const UFLSolveStats& solve_stats = solver_.last_solve_stats();
+  IterationStats stats;
+  stats.set_phase(integer_phase_ ? IterationStats::PHASE_INTEGER
+                                 : IterationStats::PHASE_LP);
+  stats.set_export_seconds(absl::ToDoubleSeconds(solve_stats.export_time));
+  stats.set_master_seconds(absl::ToDoubleSeconds(solve_stats.solve_time));
+  stats.set_lower_bound(lower_bound);
+  stats.set_upper_bound(upper_bound);
+  stats.set_simplex_iterations(solve_stats.simplex_iterations);
+  stats.set_node_count(solve_stats.node_count);
+  stats.set_solver(std::string(math_opt::EnumToString(solve_stats.solver)));
+  return stats;
+}
+
+void UFLBenders::RecordIteration(const IterationStats& stats) {
+  std::map<std::string, int>& wins = stats.phase() == IterationStats::PHASE_LP
+                                         ? stats_.lp_wins
+                                         : stats_.integer_wins;
+  wins[stats.solver()]++;
+  iterations_.push_back(stats);
+  solver_.RecordIteration(stats);
+}
+
+void UFLBenders::WarmStartInteger(const std::vector<double>& lp_open_values) {
+  const int num_facilities = problem_.num_facilities;
+  // Open every facility that is at least half open, or the most open one
+  incumbent_.assign(num_facilities, 0.0);
+  int most_open = 0;
+  for (int i = 0; i < num_facilities; i++) {
+    if (lp_open_values[i] >= 0.5) {
+      incumbent_[i] = 1.0;
+    }
+    if (lp_open_values[i] > lp_open_values[most_open]) {
+      most_open = i;
+    }
+  }
+  incumbent_[most_open] = 1.0;
+  incumbent_cost_ = kInf;
+  solver_.SetSolutionHint(incumbent_);
+
+  // Branch on the most fractional facilities first
+  std::vector<int> priorities(num_facilities);
+  for (int i = 0; i < num_facilities; i++) {
+    const double y = lp_open_values[i];
+    priorities[i] = std::lround(100 * std::min(y, 1 - y));
+  }
+  solver_.SetBranchingPriorities(priorities);
 }
 
 UFLSolution UFLBenders::Solve() {
-  UFLSolution solution = benders();
+  absl::Time start = absl::Now();
+  const absl::Time deadline = start + options_.time_limit;
+  phase_deadline_ = options_.time_limit == absl::InfiniteDuration()
+                        ? absl::InfiniteFuture()
+                        : start + options_.lp_time_fraction * options_.time_limit;
+  // The LP phase only prepares cuts, so it runs to optimality or its deadline
+  solver_.SetLimits({phase_deadline_, 0.0});
+  if (options_.stabilization != Stabilization::kNone) {
+    StabilizedBenders(&stats_.lp_iterations);
+  }
+  UFLSolution solution = benders(&stats_.lp_iterations);
+  stats_.lp_time = absl::Now() - start;
+  start = absl::Now();
   solver_.EnforceInteger();
-  solution = benders();
+  integer_phase_ = true;
+  phase_deadline_ = deadline;
+  solver_.SetLimits({deadline, options_.relative_gap});
+  if (options_.warm_start && !solution.open_values.empty()) {
+    WarmStartInteger(solution.open_values);
+  }
+  if (!heuristic_open_values_.empty()) {
+    solver_.SetSolutionHint(heuristic_open_values_);
+  }
+  if (options_.single_tree) {
+    absl::Duration separation_time;
+    int num_lazy_cuts = 0;
+    double density_sum = 0.0;
+    solution = solver_.SolveWithLazyCuts(
+        [&](const UFLSolution& candidate) {
+          const absl::Time separation_start = absl::Now();
+          double supply_cost;
+          std::vector<BendersCut> cuts = Separate(candidate, &supply_cost);
+          separation_time += absl::Now() - separation_start;
+          num_lazy_cuts += cuts.size();
+          density_sum += CutDensity(cuts) * cuts.size();
+          return cuts;
+        },
+        options_.separate_fractional);
+    stats_.num_cuts += num_lazy_cuts;
+    stats_.integer_iterations = 1;
+    IterationStats stats =
+        NewIterationStats(solution.lower_bound, solution.objective_value);
+    stats.set_phase(IterationStats::PHASE_SINGLE_TREE);
+    stats.set_separation_seconds(absl::ToDoubleSeconds(separation_time));
+    stats.set_num_cuts(num_lazy_cuts);
+    stats.set_cut_density(num_lazy_cuts > 0 ? density_sum / num_lazy_cuts
+                                            : 0.0);
+    RecordIteration(stats);
+  } else {
+    solution = benders(&stats_.integer_iterations);
+  }
+  stats_.integer_time = absl::Now() - start;
+  stats_.num_purged_cuts = solver_.num_purged_cuts();
+  stats_.num_rejected_cuts = solver_.num_rejected_cuts();
+  if (solution.open_values.empty()) {
+    // Out of time before finding an integer solution
+    return solution;
+  }
   solution.supply_values.reserve(problem_.num_customers);
   for (int i = 0; i < problem_.num_customers; i++) {
     int j;
     for (j = 0; j < problem_.num_facilities &&
-                !solution.open_values[cost_indices_[i][j]];
+                !solution.open_values[cost_indices_.facility(i, j)];
          j++) {
     }
-    solution.supply_values.push_back(cost_indices_[i][j]);
+    solution.supply_values.push_back(cost_indices_.facility(i, j));
   }
   return solution;
 }
@@ -234,57 +1426,490 @@ UFLSolution UFLBenders::Solve() {
 // HELPER FUNCTIONS
 //
 
+namespace {
+
+// Splits an ORLIB buffer into whitespace separated tokens without copying.
+class OrlibTokenizer {
+ public:
+  explicit OrlibTokenizer(absl::string_view contents)
+      : begin_(contents.data()),
+        pos_(contents.data()),
+        end_(contents.data() + contents.size()) {}
+
+  // Returns the next token, or an error if the buffer is exhausted.
+  absl::StatusOr<absl::string_view> NextToken(absl::string_view what) {
+    while (pos_ < end_ && IsSpace(*pos_)) {
+      pos_++;
+    }
+    if (pos_ == end_) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Truncated input: expected ", what, " at line ",
+                       LineNumber()));
+    }
+    const char* token_begin = pos_;
+    while (pos_ < end_ && !IsSpace(*pos_)) {
+      pos_++;
+    }
+    return absl::string_view(token_begin, pos_ - token_begin);
+  }
+
+  absl::StatusOr<double> NextDouble(absl::string_view what) {
+    absl::StatusOr<absl::string_view> token = NextToken(what);
+    if (!token.ok()) {
+      return token.status();
+    }
+    double value;
+    const char* last = token->data() + token->size();
+    const absl::from_chars_result result =
+        absl::from_chars(token->data(), last, value);
+    if (result.ec != std::errc() || result.ptr != last) {
+      return Malformed(what, *token);
+    }
+    return value;
+  }
+
+  absl::StatusOr<int> NextInt(absl::string_view what) {
+    absl::StatusOr<absl::string_view> token = NextToken(what);
+    if (!token.ok()) {
+      return token.status();
+    }
+    int value;
+    if (!absl::SimpleAtoi(*token, &value)) {
+      return Malformed(what, *token);
+    }
+    return value;
+  }
+
+ private:
+  static bool IsSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+           c == '\f';
+  }
+
+  // Only computed on error, so the hot path does not track lines.
+  int LineNumber() const { return 1 + std::count(begin_, pos_, '\n'); }
+
+  absl::Status Malformed(absl::string_view what, absl::string_view token) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Malformed input: expected ", what, " at line ", LineNumber(),
+        ", got \"", token, "\""));
+  }
+
+  const char* const begin_;
+  const char* pos_;
+  const char* const end_;
+};
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+ public:
+  static absl::StatusOr<std::unique_ptr<MappedFile>> Open(
+      const std::string& filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return absl::NotFoundError(
+          absl::StrCat("Could not open ", filename, ": ", strerror(errno)));
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      const int error = errno;
+      close(fd);
+      return absl::InternalError(
+          absl::StrCat("Could not stat ", filename, ": ", strerror(error)));
+    }
+    const size_t size = file_stat.st_size;
+    void* data = nullptr;
+    // mmap rejects empty mappings, an empty file parses as truncated anyway.
+    if (size > 0) {
+      data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        const int error = errno;
+        close(fd);
+        return absl::InternalError(
+            absl::StrCat("Could not map ", filename, ": ", strerror(error)));
+      }
+      madvise(data, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    return std::unique_ptr<MappedFile>(
+        new MappedFile(static_cast<const char*>(data), size));
+  }
+
+  ~MappedFile() {
+    if (size_ > 0) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  absl::string_view contents() const { return absl::string_view(data_, size_); }
+
+ private:
+  MappedFile(const char* data, size_t size) : data_(data), size_(size) {}
+
+  const char* const data_;
+  const size_t size_;
+};
+
+}  // namespace
+
 UFLProblem ParseProblem(const std::string& contents) {
+  absl::StatusOr<UFLProblem> problem = ParseProblemFromBuffer(contents);
+  CHECK(problem.ok()) << problem.status();
+  return *std::move(problem);
+}
+
+absl::StatusOr<UFLProblem> ParseProblemFromBuffer(absl::string_view contents) {
+  OrlibTokenizer tokens(contents);
   UFLProblem problem;
-  std::istringstream all_lines(contents);
-  std::string line;
-  std::getline(all_lines, line);
-  std::istringstream lineTokens(line);
-  lineTokens >> problem.num_facilities;
-  lineTokens >> problem.num_customers;
+  ASSIGN_OR_RETURN(problem.num_facilities, tokens.NextInt("facility count"));
+  ASSIGN_OR_RETURN(problem.num_customers, tokens.NextInt("customer count"));
+  if (problem.num_facilities <= 0 || problem.num_customers <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid problem size ", problem.num_facilities, " x ",
+                     problem.num_customers));
+  }
 
   problem.open_costs = std::vector<double>(problem.num_facilities);
-  std::string tmp;
   for (int i = 0; i < problem.num_facilities; i++) {
-    std::getline(all_lines, line);
-    lineTokens = std::istringstream(line);
-    lineTokens >> tmp;  // Ignore the capacity
-    lineTokens >> problem.open_costs[i];
+    // Ignore the capacity
+    RETURN_IF_ERROR(tokens.NextToken("facility capacity").status());
+    ASSIGN_OR_RETURN(problem.open_costs[i],
+                     tokens.NextDouble("facility open cost"));
   }
 
-  problem.supply_costs = std::vector<std::vector<double>>(
-      problem.num_customers, std::vector<double>(problem.num_facilities));
-  double cost = 0.0;
+  problem.supply_costs =
+      DenseMatrix<double>(problem.num_customers, problem.num_facilities);
   for (int i = 0; i < problem.num_customers; i++) {
     // Skip demand
-    std::getline(all_lines, line);
-    int parsed = 0;
-    while (parsed < problem.num_facilities) {
-      std::getline(all_lines, line);
-      lineTokens = std::istringstream(line);
-      while (lineTokens >> cost) {
-        problem.supply_costs[i][parsed] = cost;
-        parsed++;
-      }
+    RETURN_IF_ERROR(tokens.NextToken("customer demand").status());
+    const absl::Span<double> costs = problem.supply_costs[i];
+    for (int j = 0; j < problem.num_facilities; j++) {
+      ASSIGN_OR_RETURN(costs[j], tokens.NextDouble("supply cost"));
     }
   }
 
   return problem;
 }
 
-std::vector<double> Knapsack(const std::vector<double>& ys) {
-  std::vector<double> solution;
-  double sum = 0;
+absl::StatusOr<UFLProblem> ParseProblemFromFile(const std::string& filename) {
+  ASSIGN_OR_RETURN(const std::unique_ptr<MappedFile> file,
+                   MappedFile::Open(filename));
+  return ParseProblemFromBuffer(file->contents());
+}
+
+math_opt::ModelProto BuildDirectModelProto(const UFLProblem& problem,
+                                           bool variable_names,
+                                           bool lazy_links) {
+  const int64_t n = problem.num_customers;
+  const int64_t m = problem.num_facilities;
+  const int64_t num_variables = m + n * m;
+  const int64_t num_links = lazy_links ? m : n * m;
+  const int64_t num_constraints = n + num_links;
+  math_opt::ModelProto model;
+  model.set_name("UFL Solver");
+
+  math_opt::VariablesProto& variables = *model.mutable_variables();
+  variables.mutable_ids()->Reserve(num_variables);
+  variables.mutable_lower_bounds()->Reserve(num_variables);
+  variables.mutable_upper_bounds()->Reserve(num_variables);
+  variables.mutable_integers()->Reserve(num_variables);
+  if (variable_names) {
+    variables.mutable_names()->Reserve(num_variables);
+  }
+  math_opt::SparseDoubleVectorProto& objective =
+      *model.mutable_objective()->mutable_linear_coefficients();
+  objective.mutable_ids()->Reserve(num_variables);
+  objective.mutable_values()->Reserve(num_variables);
+  const auto add_variable = [&](int64_t id, bool integer, double cost) {
+    variables.add_ids(id);
+    variables.add_lower_bounds(0.0);
+    variables.add_upper_bounds(1.0);
+    variables.add_integers(integer);
+    if (cost != 0.0) {
+      objective.add_ids(id);
+      objective.add_values(cost);
+    }
+  };
+  for (int j = 0; j < m; j++) {
+    add_variable(j, !lazy_links, problem.open_costs[j]);
+    if (variable_names) {
+      variables.add_names(absl::StrCat("y", j));
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    const absl::Span<const double> costs = problem.supply_costs[i];
+    for (int j = 0; j < m; j++) {
+      add_variable(m + i * m + j, false, costs[j]);
+      if (variable_names) {
+        variables.add_names(absl::StrCat("x", i, ",", j));
+      }
+    }
+  }
+
+  math_opt::LinearConstraintsProto& constraints =
+      *model.mutable_linear_constraints();
+  constraints.mutable_ids()->Reserve(num_constraints);
+  constraints.mutable_lower_bounds()->Reserve(num_constraints);
+  constraints.mutable_upper_bounds()->Reserve(num_constraints);
+  for (int64_t r = 0; r < num_constraints; r++) {
+    constraints.add_ids(r);
+    // Assignment rows sum to 1, links and aggregated links are <= 0
+    constraints.add_lower_bounds(r < n ? 1.0 : -kInf);
+    constraints.add_upper_bounds(r < n ? 1.0 : 0.0);
+  }
+
+  // Entries are sorted by row, then column, as the proto requires
+  math_opt::SparseDoubleMatrixProto& matrix =
+      *model.mutable_linear_constraint_matrix();
+  const int64_t num_nonzeros = n * m + (lazy_links ? n * m + m : 2 * n * m);
+  matrix.mutable_row_ids()->Reserve(num_nonzeros);
+  matrix.mutable_column_ids()->Reserve(num_nonzeros);
+  matrix.mutable_coefficients()->Reserve(num_nonzeros);
+  const auto add_entry = [&](int64_t row, int64_t column, double value) {
+    matrix.add_row_ids(row);
+    matrix.add_column_ids(column);
+    matrix.add_coefficients(value);
+  };
+  for (int64_t i = 0; i < n; i++) {
+    for (int64_t j = 0; j < m; j++) {
+      add_entry(i, m + i * m + j, 1.0);
+    }
+  }
+  if (lazy_links) {
+    for (int64_t j = 0; j < m; j++) {
+      add_entry(n + j, j, -static_cast<double>(n));
+      for (int64_t i = 0; i < n; i++) {
+        add_entry(n + j, m + i * m + j, 1.0);
+      }
+    }
+  } else {
+    for (int64_t i = 0; i < n; i++) {
+      for (int64_t j = 0; j < m; j++) {
+        const int64_t row = n + i * m + j;
+        add_entry(row, j, -1.0);
+        add_entry(row, m + i * m + j, 1.0);
+      }
+    }
+  }
+  return model;
+}
+
+std::string SummarizeIterations(absl::Span<const IterationStats> iterations) {
+  struct PhaseTotals {
+    int num_iterations = 0;
+    double export_seconds = 0.0;
+    double master_seconds = 0.0;
+    double separation_seconds = 0.0;
+    int64_t num_cuts = 0;
+    // Weighted by the number of cuts
+    double density_sum = 0.0;
+    int64_t simplex_iterations = 0;
+    int64_t node_count = 0;
+    double lower_bound = -kInf;
+    double upper_bound = kInf;
+  };
+  std::vector<PhaseTotals> phases(IterationStats::Phase_ARRAYSIZE);
+  for (const IterationStats& stats : iterations) {
+    PhaseTotals& totals = phases[stats.phase()];
+    totals.num_iterations++;
+    totals.export_seconds += stats.export_seconds();
+    totals.master_seconds += stats.master_seconds();
+    totals.separation_seconds += stats.separation_seconds();
+    totals.num_cuts += stats.num_cuts();
+    totals.density_sum += stats.cut_density() * stats.num_cuts();
+    totals.simplex_iterations += stats.simplex_iterations();
+    totals.node_count += stats.node_count();
+    totals.lower_bound = stats.lower_bound();
+    totals.upper_bound = stats.upper_bound();
+  }
+  std::string summary;
+  for (int phase = 0; phase < phases.size(); phase++) {
+    const PhaseTotals& totals = phases[phase];
+    if (totals.num_iterations == 0) {
+      continue;
+    }
+    absl::StrAppend(
+        &summary,
+        absl::StripPrefix(IterationStats::Phase_Name(phase), "PHASE_"), ": ",
+        totals.num_iterations, " iterations, export ", totals.export_seconds,
+        "s, master ", totals.master_seconds, "s, separation ",
+        totals.separation_seconds, "s, ", totals.num_cuts,
+        " cuts (density ",
+        totals.num_cuts > 0 ? totals.density_sum / totals.num_cuts : 0.0,
+        "), ", totals.simplex_iterations, " simplex iterations, ",
+        totals.node_count, " nodes, bounds [", totals.lower_bound, ", ",
+        totals.upper_bound, "]\n");
+  }
+  return summary;
+}
+
+namespace {
+
+// Computes the Knapsack solution for the values y(0), ..., y(size - 1).
+//
+// The prefix sum is accumulated in the same order as a plain loop, so k is
+// identical to it, but the early exit is only tested once per block: the ys are
+// clamped to be non-negative, so if the sum is still below 1 at the end of a
+// block it was below 1 everywhere inside it. LP solvers can return values like
+// -1e-12, which would otherwise let the sum dip back below 1 within a block.
+// This keeps the gather free of branches so it can be vectorized.
+template <typename Gather>
+int CriticalIndex(int size, const Gather& gather, absl::Span<double> weights) {
+  constexpr int kBlockSize = 8;
+  DCHECK_GT(size, 0);
+  const auto y = [&gather](int j) { return std::max(0.0, gather(j)); };
+  double sum = 0.0;
+  int block_start = 0;
+  for (; block_start + kBlockSize <= size; block_start += kBlockSize) {
+    double block[kBlockSize];
+    for (int b = 0; b < kBlockSize; b++) {
+      block[b] = y(block_start + b);
+    }
+    double block_sum = sum;
+    for (int b = 0; b < kBlockSize; b++) {
+      block_sum += block[b];
+    }
+    if (block_sum >= 1) {
+      break;
+    }
+    sum = block_sum;
+  }
   int k;
-  for (k = 0; k < ys.size() && sum < 1; k++) {
-    sum += ys[k];
+  for (k = block_start; k < size && sum < 1; k++) {
+    sum += y(k);
   }
-  solution.reserve(k);
-  for (int i = 0; i < k - 1; i++) {
-    solution.push_back(ys[i]);
+  if (!weights.empty()) {
+    DCHECK_GE(weights.size(), k);
+    for (int i = 0; i < k - 1; i++) {
+      weights[i] = y(i);
+    }
+    weights[k - 1] = 1 - sum + y(k - 1);
+  }
+  return k;
+}
+
+template <typename Index>
+int GatherCriticalIndex(absl::Span<const double> open_values,
+                        absl::Span<const Index> indices,
+                        absl::Span<double> weights) {
+  return CriticalIndex(
+      indices.size(),
+      [open_values, indices](int j) { return open_values[indices[j]]; },
+      weights);
+}
+
+}  // namespace
+
+absl::StatusOr<CorePoint> ParseCorePoint(absl::string_view name) {
+  if (name == "none") {
+    return CorePoint::kNone;
+  }
+  if (name == "interior") {
+    return CorePoint::kInterior;
+  }
+  if (name == "average") {
+    return CorePoint::kAverage;
   }
-  solution.push_back(1 - sum + ys[k - 1]);
+  return absl::InvalidArgumentError(absl::StrCat(
+      "Unknown core point \"", name, "\", expected none, interior or average"));
+}
 
+std::string CorePointName(CorePoint core_point) {
+  switch (core_point) {
+    case CorePoint::kNone:
+      return "none";
+    case CorePoint::kInterior:
+      return "interior";
+    case CorePoint::kAverage:
+      return "average";
+  }
+  return "unknown";
+}
+
+std::string UFLSolveStatusName(UFLSolveStatus status) {
+  switch (status) {
+    case UFLSolveStatus::kOptimal:
+      return "optimal";
+    case UFLSolveStatus::kGapLimit:
+      return "gap_limit";
+    case UFLSolveStatus::kTimeLimit:
+      return "time_limit";
+    case UFLSolveStatus::kStalled:
+      return "stalled";
+  }
+  return "unknown";
+}
+
+absl::StatusOr<Stabilization> ParseStabilization(absl::string_view name) {
+  if (name == "none") {
+    return Stabilization::kNone;
+  }
+  if (name == "in_out") {
+    return Stabilization::kInOut;
+  }
+  if (name == "trust_region") {
+    return Stabilization::kTrustRegion;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown stabilization \"", name,
+                   "\", expected none, in_out or trust_region"));
+}
+
+absl::StatusOr<std::vector<math_opt::SolverType>> ParsePortfolio(
+    absl::string_view names) {
+  std::vector<math_opt::SolverType> portfolio;
+  if (names.empty()) {
+    return portfolio;
+  }
+  for (absl::string_view name : absl::StrSplit(names, ',')) {
+    const std::optional<math_opt::SolverType> type =
+        math_opt::EnumFromString<math_opt::SolverType>(name);
+    if (!type.has_value()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown solver \"", name, "\" in the portfolio"));
+    }
+    portfolio.push_back(*type);
+  }
+  return portfolio;
+}
+
+std::string StabilizationName(Stabilization stabilization) {
+  switch (stabilization) {
+    case Stabilization::kNone:
+      return "none";
+    case Stabilization::kInOut:
+      return "in_out";
+    case Stabilization::kTrustRegion:
+      return "trust_region";
+  }
+  return "unknown";
+}
+
+std::vector<double> Knapsack(const std::vector<double>& ys) {
+  const auto y = [&ys](int j) { return ys[j]; };
+  const int k = CriticalIndex(ys.size(), y, absl::Span<double>());
+  // The first k ys reach the same critical index, so the solution is only
+  // allocated at its final size
+  std::vector<double> solution(k);
+  CriticalIndex(k, y, absl::MakeSpan(solution));
   return solution;
 }
+
+int SeparateCustomer(absl::Span<const double> open_values,
+                     absl::Span<const int> indices,
+                     absl::Span<double> weights) {
+  return GatherCriticalIndex(open_values, indices, weights);
+}
+
+int SeparateCustomer(absl::Span<const double> open_values,
+                     absl::Span<const uint16_t> indices,
+                     absl::Span<double> weights) {
+  return GatherCriticalIndex(open_values, indices, weights);
+}
+
+int SeparateCustomer(absl::Span<const double> open_values,
+                     absl::Span<const uint32_t> indices,
+                     absl::Span<double> weights) {
+  return GatherCriticalIndex(open_values, indices, weights);
+}
 } // namespace math_opt_benchmark
@@ -26,7 +26,27 @@
 #ifndef MATH_OPT_BENCHMARK_FACILITY_UFL_H_
 #define MATH_OPT_BENCHMARK_FACILITY_UFL_H_
 
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "math_opt_benchmark/facility/dense_matrix.h"
+#include "math_opt_benchmark/facility/local_search.h"
+#include "math_opt_benchmark/facility/parallel_for.h"
+#include "math_opt_benchmark/facility/sorted_costs.h"
+#include "math_opt_benchmark/proto/benchmark_recorder.h"
 #include "math_opt_benchmark/proto/model.pb.h"
+#include "ortools/math_opt/model.pb.h"
 #include "third_party/ortools/ortools/math_opt/cpp/math_opt.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
@@ -36,61 +56,536 @@ struct UFLProblem {
   int num_facilities;
   int num_customers;
   std::vector<double> open_costs;  // Cost to open facility i, f_i
-  std::vector<std::vector<double>>
-      supply_costs;  // Cost for facility i to serve customer j, c_{ij}
+  // Cost for facility j to serve customer i, c_{ji}, one row per customer
+  DenseMatrix<double> supply_costs;
+};
+
+// How a solve ended. Only solves with limits stop short of kOptimal.
+enum class UFLSolveStatus {
+  kOptimal,
+  // Stopped once the objective was within the relative gap of lower_bound
+  kGapLimit,
+  // Stopped by the deadline, with the best solution found if there is one
+  kTimeLimit,
+  // Stopped with the gap open because the master already held every cut
+  // separating its solution, with the best solution found
+  kStalled,
 };
 
+std::string UFLSolveStatusName(UFLSolveStatus status);
+
 struct UFLSolution {
+  // +inf if the solve was stopped before finding a solution, in which case
+  // open_values is empty
   double objective_value;
   std::vector<double> open_values;  // The facilities that are open (0 or 1)
   std::vector<int>
       supply_values;  // supply_values[i]: which facility supplies customer i
+  // Iterative mode only: the master's estimate w_g of each customer group's
+  // supply cost
+  std::vector<double> bender_values;
+  UFLSolveStatus status = UFLSolveStatus::kOptimal;
+  // Proven lower bound on the objective, equal to it when optimal
+  double lower_bound = -std::numeric_limits<double>::infinity();
+};
+
+// Optimality cut w_group >= sum - sum_i y_coefficients[i] * y_i
+struct BendersCut {
+  int group = 0;
+  double sum = 0.0;
+  std::vector<double> y_coefficients;
+};
+
+// BendersCut with only the nonzero coefficients, y_coefficients[k] applying to
+// y_{indices[k]}. Indices are increasing.
+struct SparseBendersCut {
+  int group = 0;
+  double sum = 0.0;
+  std::vector<int> indices;
+  std::vector<double> y_coefficients;
+};
+
+// Drops the zero coefficients of `cut`
+SparseBendersCut SparsifyCut(const BendersCut &cut);
+
+// Tracks the Benders cuts in the master problem and how long each has been
+// inactive, so stale cuts can be removed and redundant ones never added.
+class BendersCutPool {
+ public:
+  explicit BendersCutPool(int max_inactive_rounds)
+      : max_inactive_rounds_(max_inactive_rounds) {}
+
+  // True if a pooled cut on the same group is at least as strong: larger or
+  // equal sum and smaller or equal coefficients. Covers exact duplicates.
+  bool IsRedundant(const SparseBendersCut &cut) const;
+  void Add(SparseBendersCut cut,
+           operations_research::math_opt::LinearConstraint constraint);
+  // A cut is active in `solution` if its slack is within tolerance, otherwise
+  // its inactivity count grows by one.
+  void UpdateSlacks(const UFLSolution &solution);
+  // Removes the cuts that have been inactive for max_inactive_rounds
+  // consecutive solutions and returns their constraints. Never purges if
+  // max_inactive_rounds is 0.
+  std::vector<operations_research::math_opt::LinearConstraint> PurgeInactive();
+  int size() const { return cuts_.size(); }
+
+ private:
+  struct PooledCut {
+    SparseBendersCut cut;
+    operations_research::math_opt::LinearConstraint constraint;
+    int inactive_rounds = 0;
+  };
+
+  int max_inactive_rounds_;
+  std::vector<PooledCut> cuts_;
+};
+
+struct UFLSolverOptions {
+  // In iterative mode the supply cost is estimated by this many epigraph
+  // variables, one per customer group.
+  int num_bender_vars = 1;
+  // Delete cuts that stay slack in this many consecutive master solutions,
+  // 0 keeps every cut.
+  int max_inactive_rounds = 0;
+  // Skip cuts that duplicate or are dominated by a cut already in the master.
+  bool filter_redundant_cuts = false;
+  // Direct formulation only: start from the aggregated links and add the
+  // violated x_ij <= y_j rows in a separation loop over the LP relaxation
+  // before solving the integer problem. Every added round is recorded as a
+  // model update.
+  bool lazy_links = false;
+  // Name the variables y<j>, w<g> and x<i>,<j>. Large instances build faster
+  // and export smaller models without names.
+  bool variable_names = true;
+  // Not owned. If set, the initial model, updates and objectives are written
+  // here as they happen instead of being kept in memory for GetModel().
+  BenchmarkRecorder *recorder = nullptr;
+  // Solvers raced against the main one on every solve, each keeping its own
+  // copy of the model in sync. The first optimal result is used and the other
+  // solves are interrupted. Solvers that cannot be created, e.g. without a
+  // license, are skipped, and a solver whose solve fails, e.g. GLOP once the
+  // model is integer, drops out of the race. SolveWithLazyCuts only uses the
+  // main solver.
+  std::vector<operations_research::math_opt::SolverType> portfolio;
+};
+
+// Parses a comma separated list of solver names, e.g. "glop,gscip,gurobi"
+absl::StatusOr<std::vector<operations_research::math_opt::SolverType>>
+ParsePortfolio(absl::string_view names);
+
+// Timing and solver statistics of a single solve
+struct UFLSolveStats {
+  // Exporting and recording the model update applied before the solve
+  absl::Duration export_time;
+  absl::Duration solve_time;
+  int64_t simplex_iterations = 0;
+  int64_t node_count = 0;
+  // Solver whose result was used, the main one unless a portfolio won
+  operations_research::math_opt::SolverType solver;
+};
+
+struct UFLModelSize {
+  int64_t num_variables = 0;
+  int64_t num_constraints = 0;
+  int64_t num_nonzeros = 0;
+  // Serialized size of the exported ModelProto
+  int64_t bytes = 0;
+};
+
+// Limits applied to every solve of a UFLSolver
+struct UFLSolveLimits {
+  // Each solve gets the time left until the deadline as its time limit
+  absl::Time deadline = absl::InfiniteFuture();
+  // Relative gap at which MIP solves stop, 0 for the solver default
+  double relative_gap = 0.0;
 };
 
+// Returns the cuts violated by a candidate master solution
+using BendersSeparator =
+    std::function<std::vector<BendersCut>(const UFLSolution &)>;
+
 class UFLSolver {
  public:
+  // In iterative mode the model is the Benders master, with only the open
+  // variables y and the epigraph variables w. Otherwise it is the direct
+  // formulation over y and the supply variables x.
   UFLSolver(operations_research::math_opt::SolverType solver_type,
-            const UFLProblem &problem, bool iterative);
+            const UFLProblem &problem, bool iterative,
+            const UFLSolverOptions &options = UFLSolverOptions());
   UFLSolution Solve();
+  // Solves the integer master once, calling `separator` on every integer
+  // candidate (and on fractional node solutions if `separate_fractional`) and
+  // adding the returned cuts as lazy constraints. The cuts are added to the
+  // model after the solve, so GetModel() records them in the update before the
+  // objective. Needs a solver that supports lazy constraints, e.g. Gurobi.
+  UFLSolution SolveWithLazyCuts(const BendersSeparator &separator,
+                                bool separate_fractional);
   void AddBenderCut(double sum, const std::vector<double> &y_coefficients);
+  // Purges inactive cuts and adds the non-redundant `cuts`. A cut that cuts
+  // off the last master solution is never redundant. Returns the number of
+  // cuts added.
+  int AddBenderCuts(const std::vector<BendersCut> &cuts);
+  // Same for sparse cuts, only setting their nonzero coefficients. The whole
+  // batch is part of the single model update recorded before the next solve.
+  int AddBenderCuts(absl::Span<const SparseBendersCut> cuts);
   void EnforceInteger();
+  // Restricts every open variable y_j to [lower[j], upper[j]]. Only changed
+  // bounds become part of the next model update.
+  void SetOpenBounds(const std::vector<double> &lower,
+                     const std::vector<double> &upper);
+  // Limits every following solve, which then reports a status instead of
+  // requiring optimality
+  void SetLimits(const UFLSolveLimits &limits) { limits_ = limits; }
+  // Passes `open_values` as a solution hint to every following solve. The
+  // epigraph variables are left for the solver to complete.
+  void SetSolutionHint(const std::vector<double> &open_values);
+  // Branching priorities of the open variables for every following solve,
+  // higher values are branched on first. Only passed to solvers that support
+  // them, i.e. Gurobi and SCIP.
+  void SetBranchingPriorities(const std::vector<int> &priorities);
+  // `solve_args` with the solution hint and branching priorities that the
+  // next solve passes to a solver of `solver_type`
+  operations_research::math_opt::SolveArguments SolveArgumentsFor(
+      operations_research::math_opt::SolverType solver_type,
+      operations_research::math_opt::SolveArguments solve_args = {}) const;
+  // The initial model, and for every solve after the first the model update
+  // applied before it and the resulting objective. Solves stopped by a limit
+  // before finding a solution are left out, their changes become part of the
+  // next recorded update, and so are their iteration records. If the initial
+  // model itself was never recorded with a solution, its objective is NaN.
+  // Empty if the options stream the recording to another recorder.
   BenchmarkInstance GetModel();
+  // The update the next solve will record, without consuming it
+  std::optional<operations_research::math_opt::ModelUpdateProto>
+  PendingModelUpdate() const;
+  int num_purged_cuts() const { return num_purged_cuts_; }
+  int num_rejected_cuts() const { return num_rejected_cuts_; }
+  // Links x_ij <= y_j added by the lazy_links separation
+  int num_lazy_links() const { return num_lazy_links_; }
+  const UFLSolveStats &last_solve_stats() const { return last_solve_stats_; }
+  // Passes telemetry of the algorithm driving the solver to the recorder,
+  // unless the last solve was left out of the recording
+  void RecordIteration(const IterationStats &stats);
+  // Size of the model before the first solve
+  const UFLModelSize &initial_model_size() const { return initial_model_size_; }
 
  private:
-  operations_research::math_opt::Model model_;
-  std::unique_ptr<operations_research::math_opt::IncrementalSolver> solver_;
+  // Fills supply_fractions, if given, with the values of x. Adds lazy_cuts,
+  // if given, to the model once the solve is done.
+  UFLSolution SolveWithArguments(
+      operations_research::math_opt::SolveArguments solve_args,
+      DenseMatrix<double> *supply_fractions = nullptr,
+      const std::vector<BendersCut> *lazy_cuts = nullptr);
+  UFLSolution SolveWithLazyLinks();
+  // Adds x_ij <= y_j for every pair violated by the LP solution, returns the
+  // number of rows added.
+  int AddViolatedLinks(const std::vector<double> &open_values,
+                       const DenseMatrix<double> &supply_fractions);
+  // Solves with every solver of the portfolio in parallel, or only with the
+  // main one if there is a callback, and returns the result used. Sets
+  // last_solve_stats_.solver.
+  absl::StatusOr<operations_research::math_opt::SolveResult> RaceSolve(
+      const operations_research::math_opt::SolveArguments &solve_args);
+  // Records the changes since the previous recorded solve and the objective
+  // of the solve that followed them
+  void RecordSolve(double objective);
+  operations_research::math_opt::LinearConstraint AddCutConstraint(
+      const SparseBendersCut &cut);
+  // Whether `cut` is violated by the last master solution, false before the
+  // first one
+  bool CutsOffLastSolution(const SparseBendersCut &cut) const;
+  operations_research::math_opt::LinearExpression CutExpression(
+      const BendersCut &cut) const;
+
+  std::unique_ptr<operations_research::math_opt::Model> model_;
+  struct Backend {
+    operations_research::math_opt::SolverType type;
+    std::unique_ptr<operations_research::math_opt::IncrementalSolver> solver;
+  };
+  // The main solver first, then the rest of the portfolio
+  std::vector<Backend> backends_;
   std::unique_ptr<operations_research::math_opt::UpdateTracker> update_tracker_;
   std::vector<std::vector<operations_research::math_opt::Variable>>
       supply_vars_;
   std::vector<operations_research::math_opt::Variable> open_vars_;
-  operations_research::math_opt::Variable bender_var_;
-  BenchmarkInstance instance_;
+  std::vector<operations_research::math_opt::Variable> bender_vars_;
+  InstanceRecorder instance_recorder_;
+  BenchmarkRecorder *recorder_;
+  int num_recorded_solves_ = 0;
+  bool last_solve_recorded_ = false;
   bool iterative_;
+  UFLSolverOptions options_;
+  BendersCutPool cut_pool_;
+  UFLSolveLimits limits_;
+  std::vector<double> hint_open_values_;
+  std::vector<int> branching_priorities_;
+  // Iterative mode only: the last master solution found, empty before it
+  std::vector<double> last_open_values_;
+  std::vector<double> last_bender_values_;
+  int num_purged_cuts_ = 0;
+  int num_rejected_cuts_ = 0;
+  int num_lazy_links_ = 0;
+  UFLSolveStats last_solve_stats_;
+  UFLModelSize initial_model_size_;
+};
+
+// How UFLBenders picks each customer's dual when the subproblem is
+// degenerate, e.g. at integer master solutions.
+enum class CorePoint {
+  // The dual of the critical facility, see SeparateCustomer
+  kNone,
+  // Pareto-optimal (Magnanti-Wong) cuts, the strongest at the interior point
+  // where every facility is half open
+  kInterior,
+  // Pareto-optimal cuts, the strongest at the running average of the master
+  // solutions, starting from the interior point
+  kAverage,
+};
+
+absl::StatusOr<CorePoint> ParseCorePoint(absl::string_view name);
+std::string CorePointName(CorePoint core_point);
+
+// Stabilization of the LP phase of UFLBenders. Stabilized iterations run until
+// they stop improving, then the plain loop finishes the phase.
+enum class Stabilization {
+  kNone,
+  // Separate at in_out_alpha * y + (1 - in_out_alpha) * center, where the
+  // stability center starts with every facility open and moves halfway to each
+  // separation point. Cuts not violated by the master solution are dropped.
+  kInOut,
+  // Bound y to a box of trust_region_radius around the stability center, the
+  // best solution found so far. The box is applied as variable bound updates
+  // and removed at the end, so the recording still replays.
+  kTrustRegion,
+};
+
+absl::StatusOr<Stabilization> ParseStabilization(absl::string_view name);
+std::string StabilizationName(Stabilization stabilization);
+
+struct UFLBendersOptions {
+  // Threads used to generate each Benders cut. The cut is bit-identical to the
+  // single-threaded one for every thread count.
+  int num_threads = 1;
+  // With several threads, customers are separated in contiguous shards of this
+  // size. Only changes how the work is scheduled, not the cut.
+  int customers_per_shard = 512;
+  // Number of epigraph variables in the master. 1 adds a single aggregated
+  // cut per iteration, larger values split the customers into this many
+  // contiguous groups (up to one per customer) and add a cut for every group
+  // whose estimate is violated.
+  int num_cut_groups = 1;
+  // Solve the integer phase as a single branch-and-bound with Benders cuts
+  // added as lazy constraints, instead of one MIP solve per cut.
+  bool single_tree = false;
+  // In single tree mode, also separate fractional node solutions.
+  bool separate_fractional = false;
+  // Hint the integer master with the rounded LP solution and then with the
+  // best integer solution found, and branch first on the facilities that are
+  // most fractional in the LP.
+  bool warm_start = false;
+  CorePoint core_point = CorePoint::kNone;
+  Stabilization stabilization = Stabilization::kNone;
+  // Weight of the master solution in the in-out separation point
+  double in_out_alpha = 0.2;
+  double trust_region_radius = 0.5;
+  // Separate each master solution by revisiting only the customers whose
+  // critical facility may have moved: those where a facility whose y changed
+  // since the previous separation precedes the critical position. Ignored
+  // with a core point, whose cuts depend on more than the critical indices.
+  bool incremental_separation = false;
+  // Improve every separated master solution with the add/drop/swap local
+  // search, tightening the upper bound and hinting the integer master with
+  // the best solution found.
+  bool local_search = false;
+  // Anytime mode: stop once time_limit has passed, or once the best integer
+  // solution is within relative_gap of the lower bound, and return the best
+  // solution found with its status. The LP phase gets lp_time_fraction of the
+  // time and the integer phase the rest, each master solve being limited to
+  // the time left in its phase.
+  absl::Duration time_limit = absl::InfiniteDuration();
+  double relative_gap = 0.0;
+  double lp_time_fraction = 0.25;
+  // If set, the supply costs sorted per customer are cached in this directory
+  // under a hash of the instance, and reused by later runs on the same costs.
+  std::string presort_cache_dir;
+  // Options of the master problem. num_bender_vars is set from num_cut_groups.
+  UFLSolverOptions master;
+};
+
+struct UFLBendersStats {
+  int lp_iterations = 0;
+  int integer_iterations = 0;
+  int num_cuts = 0;
+  int num_purged_cuts = 0;
+  int num_rejected_cuts = 0;
+  // Sorting the supply costs of every customer, or loading them from cache
+  absl::Duration presort_time;
+  // Local search runs that improved the best solution, and their total time
+  int num_local_search_incumbents = 0;
+  absl::Duration local_search_time;
+  // Separations done incrementally, and the customers they revisited
+  int num_incremental_separations = 0;
+  int64_t num_revisited_customers = 0;
+  absl::Duration lp_time;
+  absl::Duration integer_time;
+  // Master solves won by each solver, by name, see UFLSolverOptions::portfolio
+  std::map<std::string, int> lp_wins;
+  std::map<std::string, int> integer_wins;
 };
 
 class UFLBenders {
  public:
   explicit UFLBenders(const UFLProblem &problem,
                       operations_research::math_opt::SolverType solver_type =
-                          operations_research::math_opt::SolverType::kGurobi);
+                          operations_research::math_opt::SolverType::kGurobi,
+                      const UFLBendersOptions &options = UFLBendersOptions());
   UFLSolution Solve();
   BenchmarkInstance GetModel() { return solver_.GetModel(); }
+  // The Benders master, with the state left by the last Solve()
+  const UFLSolver &master() const { return solver_; }
+  const UFLBendersStats &stats() const { return stats_; }
+  // One entry per master solve, also recorded in GetModel()
+  const std::vector<IterationStats> &iterations() const { return iterations_; }
+
+  // Builds the aggregated cut separating the master solution `open_values`
+  BendersCut GenerateCut(const std::vector<double> &open_values);
+
+  // Builds the cut of every customer group whose estimate in `solution` is
+  // violated. Sets `supply_cost` to the true supply cost at the solution.
+  std::vector<BendersCut> GenerateGroupCuts(const UFLSolution &solution,
+                                            double *supply_cost);
+
+  // Returns the cuts violated by `solution`, aggregated or per group depending
+  // on the options. Sets `supply_cost` as GenerateGroupCuts.
+  std::vector<BendersCut> Separate(const UFLSolution &solution,
+                                   double *supply_cost);
 
  private:
-  // Add benders cuts until optimal
-  UFLSolution benders();
+  // Add benders cuts until optimal or out of budget, counting the master
+  // re-solves. Returns the last master solution if it is optimal, otherwise
+  // the best one separated.
+  UFLSolution benders(int *iterations);
+  // Whether the phase should stop at these bounds, setting `status` if so
+  bool BudgetExhausted(double lower_bound, double upper_bound,
+                       UFLSolveStatus *status) const;
+  // Runs stabilized LP iterations until they stall, counting the master
+  // solves. The master is left with the cuts found and its original bounds.
+  void StabilizedBenders(int *iterations);
+  // Hints the master with the rounded LP solution and sets branching
+  // priorities from it
+  void WarmStartInteger(const std::vector<double> &lp_open_values);
+  // Runs the local search from `open_values`, keeping the result if it is
+  // the best solution found
+  void RunLocalSearch(const std::vector<double> &open_values);
+  // Moves the running average core point towards `open_values`
+  void UpdateCorePoint(const std::vector<double> &open_values);
+  // Separates `solution` by updating the group cuts of the previous
+  // separation for the customers whose critical index changed. Returns false
+  // without separating if the state is missing, stale, or too many customers
+  // are affected for the update to pay off.
+  bool SeparateIncrementally(const UFLSolution &solution,
+                             std::vector<BendersCut> *cuts,
+                             double *supply_cost);
+  // Starts the incremental state over from a full separation at `open_values`,
+  // whose group cuts and critical indices have already been stored
+  void ResetSeparationState(const std::vector<double> &open_values);
+  // Starts the telemetry of the master solve that just finished
+  IterationStats NewIterationStats(double lower_bound, double upper_bound) const;
+  void RecordIteration(const IterationStats &stats);
 
   UFLProblem problem_;
+  UFLBendersOptions options_;
   UFLSolver solver_;
-  std::vector<std::vector<int>> cost_indices_;
+  // Threads for cut generation, started once instead of on every iteration
+  ThreadPool pool_;
+  // The facilities sorted by increasing supply cost to each customer
+  FacilityOrder cost_indices_;
+  // Multi-threaded GenerateCut state, reused between iterations: the dual of
+  // every customer, and for every shard and column block the (facility, term)
+  // pairs of its customers' coefficients, at shard * num_column_blocks_ + block
+  int num_column_blocks_ = 0;
+  int column_block_ = 0;
+  std::vector<double> customer_duals_;
+  std::vector<std::vector<std::pair<int, double>>> shard_terms_;
+  // Point the cuts are made Pareto-optimal at, empty for CorePoint::kNone
+  std::vector<double> core_point_;
+  int num_core_samples_ = 0;
+
+  // Incremental separation state, see UFLBendersOptions::incremental_separation
+  struct CustomerPosition {
+    int customer;
+    // Of the facility in the customer's sorted costs
+    int position;
+  };
+  bool incremental_ = false;
+  // The last separated master solution and its cut of every group, including
+  // the ones that were not violated
+  std::vector<double> separated_open_values_;
+  DenseMatrix<double> group_coefficients_;
+  std::vector<double> group_sums_;
+  // Critical index of every customer at separated_open_values_
+  std::vector<int> critical_indices_;
+  // For every facility, customers where it was at some point before the
+  // critical index. Entries at or past the current critical index are stale
+  // and skipped. indexed_positions_[i] is the number of positions of customer
+  // i in the index.
+  std::vector<std::vector<CustomerPosition>> facility_customers_;
+  std::vector<int> indexed_positions_;
+  // Last separation that revisited each customer, to visit it once
+  std::vector<int> customer_marks_;
+  int num_separations_ = 0;
+  // Incremental separations since the last full one
+  int num_incremental_rounds_ = 0;
+  UFLBendersStats stats_;
+  std::vector<IterationStats> iterations_;
+  // Set once the master's open variables are integer
+  bool integer_phase_ = false;
+  // End of the current phase's share of options_.time_limit
+  absl::Time phase_deadline_ = absl::InfiniteFuture();
+  // Best solution found by the local search and its cost
+  std::vector<double> heuristic_open_values_;
+  double heuristic_cost_ = std::numeric_limits<double>::infinity();
+  // Best integer solution found so far and its cost, if warm starting
+  std::vector<double> incumbent_;
+  double incumbent_cost_ = std::numeric_limits<double>::infinity();
 };
 
 /* HELPER FUNCTIONS */
 
 // Reads the UFL problem in ORLIB-cap format from a string
 // https://resources.mpi-inf.mpg.de/departments/d1/projects/benchmarks/UflLib/data-format.html
+// CHECK-fails on malformed input, see ParseProblemFromBuffer.
 UFLProblem ParseProblem(const std::string &contents);
 
+// Same as ParseProblem, but tokenizes the buffer in place and returns an
+// InvalidArgument error (with the offending line number) if the contents are
+// malformed or truncated.
+absl::StatusOr<UFLProblem> ParseProblemFromBuffer(absl::string_view contents);
+
+// Memory-maps the file at `filename` and parses it with ParseProblemFromBuffer,
+// avoiding a copy of the whole file into a string.
+absl::StatusOr<UFLProblem> ParseProblemFromFile(const std::string &filename);
+
+// Builds the direct formulation
+//   min  sum_j f_j y_j + sum_{ij} c_{ij} x_{ij}
+//   s.t. sum_j x_{ij} = 1        for all customers i
+//        x_{ij} - y_j <= 0       for all i, j
+//        0 <= x, y <= 1, y integer
+// in a single pass over the costs. Variable ids are y_j = j followed by
+// x_{ij} = m + i*m + j, constraint ids are the n assignment rows followed by
+// the links in the same customer-major order.
+//
+// With lazy_links the n*m links are replaced by the m aggregated rows
+//   sum_i x_{ij} - n*y_j <= 0    for all facilities j
+// (ids n + j) and y is left continuous, so that the LP relaxation can be
+// tightened with the violated links before the integer solve.
+operations_research::math_opt::ModelProto BuildDirectModelProto(
+    const UFLProblem &problem, bool variable_names, bool lazy_links = false);
+
+// Totals of every phase in `iterations`: time spent exporting updates, in the
+// master and in separation, cuts, density, solver work and the final bounds.
+std::string SummarizeIterations(absl::Span<const IterationStats> iterations);
+
 // Solves the worker problem for a fixed j:
 // min_x sum_{ij} c_{ij}*x_{ij}
 //  s.t. sum_i x_{ij} = 1
@@ -103,8 +598,25 @@ UFLProblem ParseProblem(const std::string &contents);
 // When we call this from UFLBenders, We assume the ys are sorted according to
 // costs c_{ij} (costs[i] <= costs[i+1]), so greedily choosing ys[i] before
 // ys[i+1] will minimize the cost
+//
+// Compatibility wrapper around SeparateCustomer for an already sorted ys.
 std::vector<double> Knapsack(const std::vector<double> &ys);
 
+// Allocation-free form of Knapsack that gathers ys[j] = open_values[indices[j]]
+// on the fly. Returns the critical index k, the number of facilities (in
+// increasing cost order) used to serve the customer, i.e. the size of the
+// Knapsack solution. If `weights` is non-empty it must hold at least k entries
+// and receives the Knapsack solution.
+int SeparateCustomer(absl::Span<const double> open_values,
+                     absl::Span<const int> indices,
+                     absl::Span<double> weights = {});
+int SeparateCustomer(absl::Span<const double> open_values,
+                     absl::Span<const uint16_t> indices,
+                     absl::Span<double> weights = {});
+int SeparateCustomer(absl::Span<const double> open_values,
+                     absl::Span<const uint32_t> indices,
+                     absl::Span<double> weights = {});
+
 } // namespace math_opt_benchmark
 
 #endif //MATH_OPT_BENCHMARK_FACILITY_UFL_H_
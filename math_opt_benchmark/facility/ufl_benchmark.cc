@@ -0,0 +1,184 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of the UFL kernels that run on every Benders iteration or
+// once per instance, without solving anything.
+//
+// Unless noted otherwise the arguments are {num_facilities, num_customers,
+// fractional}, where fractional selects master solutions with fractional open
+// values (as in the LP phase) instead of integral ones.
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/random/random.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "math_opt_benchmark/facility/sorted_costs.h"
+#include "math_opt_benchmark/facility/ufl.h"
+#include "math_opt_benchmark/facility/ufl_generator.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+namespace math_opt = ::operations_research::math_opt;
+
+constexpr uint64_t kSeed = 1234;
+
+UFLProblem RandomProblem(int num_facilities, int num_customers) {
+  UFLGeneratorOptions options;
+  options.family = UFLFamily::kKorkelGhosh;
+  options.num_facilities = num_facilities;
+  options.num_customers = num_customers;
+  options.seed = kSeed;
+  return GenerateProblem(options);
+}
+
+// Fractional values are uniform in [0, 1], integral ones open about a tenth
+// of the facilities and always at least one.
+std::vector<double> RandomOpenValues(int num_facilities, bool fractional) {
+  absl::BitGen gen(std::seed_seq{kSeed + 1});
+  std::vector<double> open_values(num_facilities);
+  for (double& y : open_values) {
+    y = fractional ? absl::Uniform(gen, 0.0, 1.0)
+                   : absl::Bernoulli(gen, 0.1) ? 1.0 : 0.0;
+  }
+  if (!fractional) {
+    open_values[0] = 1.0;
+  }
+  return open_values;
+}
+
+// Arguments {num_facilities, num_customers}
+void BM_ParseProblem(benchmark::State& state) {
+  const std::string contents =
+      FormatOrlib(RandomProblem(state.range(0), state.range(1)));
+  for (auto s : state) {
+    absl::StatusOr<UFLProblem> problem = ParseProblemFromBuffer(contents);
+    benchmark::DoNotOptimize(problem);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(1));
+  state.SetBytesProcessed(state.iterations() * contents.size());
+}
+BENCHMARK(BM_ParseProblem)->ArgsProduct({{50, 1000}, {1000, 10000}});
+
+// Arguments {num_facilities, fractional}, the ys are in cost order.
+void BM_Knapsack(benchmark::State& state) {
+  const std::vector<double> ys = RandomOpenValues(state.range(0), state.range(1));
+  for (auto s : state) {
+    std::vector<double> solution = Knapsack(ys);
+    benchmark::DoNotOptimize(solution);
+  }
+  state.SetItemsProcessed(state.iterations() * ys.size());
+  state.SetBytesProcessed(state.iterations() * ys.size() * sizeof(double));
+}
+BENCHMARK(BM_Knapsack)->ArgsProduct({{50, 1000, 10000}, {0, 1}});
+
+void BM_GenerateCut(benchmark::State& state) {
+  const int num_facilities = state.range(0);
+  const int num_customers = state.range(1);
+  UFLBendersOptions options;
+  options.core_point =
+      state.range(3) ? CorePoint::kInterior : CorePoint::kNone;
+  UFLBenders benders(RandomProblem(num_facilities, num_customers),
+                     math_opt::SolverType::kGlop, options);
+  const std::vector<double> open_values =
+      RandomOpenValues(num_facilities, state.range(2));
+  for (auto s : state) {
+    BendersCut cut = benders.GenerateCut(open_values);
+    benchmark::DoNotOptimize(cut);
+  }
+  // Nominal throughput over the sorted costs and facility indices, each
+  // customer stops reading them at its critical index
+  const int64_t entries = int64_t{num_facilities} * num_customers;
+  const int64_t index_bytes = FacilityOrder::IsNarrow(num_facilities)
+                                  ? sizeof(uint16_t)
+                                  : sizeof(uint32_t);
+  state.SetItemsProcessed(state.iterations() * entries);
+  state.SetBytesProcessed(state.iterations() * entries *
+                          (sizeof(double) + index_bytes));
+}
+// The last argument generates Pareto-optimal cuts at the interior point
+BENCHMARK(BM_GenerateCut)
+    ->ArgsProduct({{50, 1000}, {1000, 10000}, {0, 1}, {0, 1}});
+
+// Adds kCutsPerBatch cuts to a fresh master and exports the update the next
+// solve would record. Arguments {num_facilities, num_customers, fractional,
+// sparse}, adding dense cuts one at a time or the sparse cuts as one batch.
+void BM_AddBenderCut(benchmark::State& state) {
+  constexpr int kCutsPerBatch = 16;
+  const int num_facilities = state.range(0);
+  const UFLProblem problem = RandomProblem(num_facilities, state.range(1));
+  UFLBenders benders(problem, math_opt::SolverType::kGlop);
+  std::vector<BendersCut> cuts;
+  for (int k = 0; k < kCutsPerBatch; k++) {
+    std::vector<double> open_values =
+        RandomOpenValues(num_facilities, state.range(2));
+    std::rotate(open_values.begin(), open_values.begin() + k % num_facilities,
+                open_values.end());
+    cuts.push_back(benders.GenerateCut(open_values));
+  }
+  const bool sparse = state.range(3);
+  std::vector<SparseBendersCut> sparse_cuts;
+  for (const BendersCut& cut : cuts) {
+    sparse_cuts.push_back(SparsifyCut(cut));
+  }
+  int64_t update_bytes = 0;
+  for (auto s : state) {
+    state.PauseTiming();
+    UFLSolver solver(math_opt::SolverType::kGlop, problem, true);
+    state.ResumeTiming();
+    if (sparse) {
+      solver.AddBenderCuts(absl::MakeConstSpan(sparse_cuts));
+    } else {
+      for (const BendersCut& cut : cuts) {
+        solver.AddBenderCut(cut.sum, cut.y_coefficients);
+      }
+    }
+    const std::optional<math_opt::ModelUpdateProto> update =
+        solver.PendingModelUpdate();
+    update_bytes += update.has_value() ? update->ByteSizeLong() : 0;
+  }
+  state.SetItemsProcessed(state.iterations() * kCutsPerBatch);
+  state.SetBytesProcessed(update_bytes);
+}
+BENCHMARK(BM_AddBenderCut)
+    ->ArgsProduct({{50, 1000}, {1000}, {0, 1}, {0, 1}});
+
+// Arguments {num_facilities, num_customers, iterative}
+void BM_UFLSolverConstructor(benchmark::State& state) {
+  const UFLProblem problem = RandomProblem(state.range(0), state.range(1));
+  const bool iterative = state.range(2);
+  UFLSolverOptions options;
+  options.variable_names = false;
+  UFLModelSize size;
+  for (auto s : state) {
+    UFLSolver solver(math_opt::SolverType::kGlop, problem, iterative, options);
+    size = solver.initial_model_size();
+  }
+  state.SetItemsProcessed(state.iterations() * size.num_nonzeros);
+  state.SetBytesProcessed(state.iterations() * size.bytes);
+}
+BENCHMARK(BM_UFLSolverConstructor)
+    ->ArgsProduct({{50, 1000}, {1000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace math_opt_benchmark
@@ -0,0 +1,248 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/ufl_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "math_opt_benchmark/facility/parallel_for.h"
+#include "ortools/base/logging.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+constexpr int kCustomersPerShard = 256;
+
+// SplitMix64, small and fully specified so instances do not depend on the
+// standard library's distributions.
+class Random {
+ public:
+  // Independent streams for the same seed, e.g. one per customer
+  Random(uint64_t seed, uint64_t stream)
+      : state_(Mix(seed + 0x9e3779b97f4a7c15 * (stream + 1))) {}
+
+  uint64_t Next() { return Mix(state_ += 0x9e3779b97f4a7c15); }
+
+  // Uniform integer in [lo, hi]
+  int64_t UniformInt(int64_t lo, int64_t hi) {
+    return lo + static_cast<int64_t>(Next() % static_cast<uint64_t>(hi - lo + 1));
+  }
+
+  // Uniform in [lo, hi)
+  double Uniform(double lo, double hi) {
+    return lo + (hi - lo) * (static_cast<double>(Next() >> 11) * 0x1.0p-53);
+  }
+
+  // Irwin-Hall approximation of a standard normal, which unlike Box-Muller
+  // needs no transcendental functions
+  double Normal() {
+    double sum = -6.0;
+    for (int k = 0; k < 12; k++) {
+      sum += Uniform(0.0, 1.0);
+    }
+    return sum;
+  }
+
+ private:
+  static uint64_t Mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
+  uint64_t state_;
+};
+
+// Streams of the seed, customer i uses kCustomerStreams + i
+enum Stream : uint64_t {
+  kOpenCostStream = 0,
+  kFacilityStream = 1,
+  kClusterStream = 2,
+  kCustomerStreams = 3,
+};
+
+struct Point {
+  double x;
+  double y;
+};
+
+// Must not be contracted to an FMA, see the BUILD copts
+double Distance(const Point &a, const Point &b) {
+  const double dx = a.x - b.x;
+  const double dy = a.y - b.y;
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+// Fills the supply costs of customer i from its own stream
+void GenerateCustomer(const UFLGeneratorOptions &options,
+                      absl::Span<const Point> facilities,
+                      absl::Span<const Point> clusters, int i,
+                      absl::Span<double> costs) {
+  Random random(options.seed, kCustomerStreams + i);
+  if (options.family == UFLFamily::kKorkelGhosh) {
+    for (double &cost : costs) {
+      cost = random.UniformInt(1000, 2000);
+    }
+    return;
+  }
+  Point customer;
+  if (options.family == UFLFamily::kClustered) {
+    const Point &center = clusters[random.Next() % clusters.size()];
+    customer.x = std::clamp(
+        center.x + options.cluster_stddev * random.Normal(), 0.0, 1.0);
+    customer.y = std::clamp(
+        center.y + options.cluster_stddev * random.Normal(), 0.0, 1.0);
+  } else {
+    customer.x = random.Uniform(0, 1);
+    customer.y = random.Uniform(0, 1);
+  }
+  for (int j = 0; j < costs.size(); j++) {
+    costs[j] = std::round(options.distance_cost *
+                          Distance(customer, facilities[j]));
+  }
+}
+
+void AppendNumber(std::string &out, double value) {
+  absl::StrAppendFormat(&out, "%.17g", value);
+}
+
+// Appends the sizes and the facilities' capacities and open costs
+void AppendHeader(const UFLProblem &problem, std::string &out) {
+  absl::StrAppend(&out, problem.num_facilities, " ", problem.num_customers,
+                  "\n");
+  for (const double cost : problem.open_costs) {
+    out += "0 ";
+    AppendNumber(out, cost);
+    out += "\n";
+  }
+}
+
+// Appends the demand and supply costs of customer i
+void AppendCustomer(const UFLProblem &problem, int i, std::string &out) {
+  out += "0\n";
+  const absl::Span<const double> costs = problem.supply_costs[i];
+  for (int j = 0; j < costs.size(); j++) {
+    if (j > 0) {
+      out += " ";
+    }
+    AppendNumber(out, costs[j]);
+  }
+  out += "\n";
+}
+
+}  // namespace
+
+absl::StatusOr<UFLFamily> ParseUFLFamily(absl::string_view name) {
+  if (name == "euclidean") {
+    return UFLFamily::kEuclidean;
+  }
+  if (name == "clustered") {
+    return UFLFamily::kClustered;
+  }
+  if (name == "korkel_ghosh") {
+    return UFLFamily::kKorkelGhosh;
+  }
+  return absl::InvalidArgumentError(absl::StrCat(
+      "Unknown UFL family \"", name,
+      "\", expected euclidean, clustered or korkel_ghosh"));
+}
+
+UFLProblem GenerateProblem(const UFLGeneratorOptions &options) {
+  CHECK_GT(options.num_facilities, 0);
+  CHECK_GT(options.num_customers, 0);
+  CHECK_LE(options.min_open_cost, options.max_open_cost);
+  UFLProblem problem;
+  problem.num_facilities = options.num_facilities;
+  problem.num_customers = options.num_customers;
+
+  Random open_random(options.seed, kOpenCostStream);
+  problem.open_costs.resize(options.num_facilities);
+  for (double &cost : problem.open_costs) {
+    cost = open_random.UniformInt(options.min_open_cost, options.max_open_cost);
+  }
+
+  std::vector<Point> facilities;
+  std::vector<Point> clusters;
+  if (options.family != UFLFamily::kKorkelGhosh) {
+    Random facility_random(options.seed, kFacilityStream);
+    facilities.resize(options.num_facilities);
+    for (Point &facility : facilities) {
+      facility.x = facility_random.Uniform(0, 1);
+      facility.y = facility_random.Uniform(0, 1);
+    }
+  }
+  if (options.family == UFLFamily::kClustered) {
+    CHECK_GT(options.num_clusters, 0);
+    Random cluster_random(options.seed, kClusterStream);
+    clusters.resize(options.num_clusters);
+    for (Point &center : clusters) {
+      center.x = cluster_random.Uniform(0, 1);
+      center.y = cluster_random.Uniform(0, 1);
+    }
+  }
+
+  problem.supply_costs =
+      DenseMatrix<double>(options.num_customers, options.num_facilities);
+  const int num_shards =
+      (options.num_customers + kCustomersPerShard - 1) / kCustomersPerShard;
+  ParallelFor(options.num_threads, num_shards, [&](int shard) {
+    const int end =
+        std::min(options.num_customers, (shard + 1) * kCustomersPerShard);
+    for (int i = shard * kCustomersPerShard; i < end; i++) {
+      GenerateCustomer(options, facilities, clusters, i,
+                       problem.supply_costs[i]);
+    }
+  });
+  return problem;
+}
+
+std::string FormatOrlib(const UFLProblem &problem) {
+  std::string out;
+  AppendHeader(problem, out);
+  for (int i = 0; i < problem.num_customers; i++) {
+    AppendCustomer(problem, i, out);
+  }
+  return out;
+}
+
+absl::Status WriteOrlib(const UFLProblem &problem,
+                        const std::string &filename) {
+  std::ofstream output(filename, std::ios::trunc);
+  if (!output.is_open()) {
+    return absl::NotFoundError(absl::StrCat("Could not open ", filename));
+  }
+  // Written a customer at a time, so a 10k x 10k instance never has its
+  // whole text in memory
+  std::string buffer;
+  AppendHeader(problem, buffer);
+  output << buffer;
+  for (int i = 0; i < problem.num_customers; i++) {
+    buffer.clear();
+    AppendCustomer(problem, i, buffer);
+    output << buffer;
+  }
+  output.close();
+  if (output.fail()) {
+    return absl::DataLossError(absl::StrCat("Failed writing ", filename));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace math_opt_benchmark
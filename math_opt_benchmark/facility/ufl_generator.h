@@ -0,0 +1,80 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Seeded synthetic UFL instances, for scaling studies beyond the ORLIB sizes.
+//
+// Generation uses a private random number generator and only exactly rounded
+// floating point operations, so an instance is a function of its options
+// alone: the same seed gives the same costs on every platform and for any
+// number of threads. The target is built with -ffp-contract=off so that no
+// compiler fuses the operations into FMAs, which round differently. Every cost
+// is rounded to an integer, so writing an instance in ORLIB format and parsing
+// it back is exact.
+
+#ifndef MATH_OPT_BENCHMARK_FACILITY_UFL_GENERATOR_H_
+#define MATH_OPT_BENCHMARK_FACILITY_UFL_GENERATOR_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "math_opt_benchmark/facility/ufl.h"
+
+namespace math_opt_benchmark {
+
+enum class UFLFamily {
+  // Facilities and customers are uniform points in the unit square, supply
+  // costs are their distances
+  kEuclidean,
+  // As kEuclidean, but customers are spread around a few cluster centers with
+  // an approximately normal offset
+  kClustered,
+  // Körkel-Ghosh: supply costs uniform in [1000, 2000], open costs as set in
+  // the options (the original families use [100, 200], [1000, 2000] and
+  // [10000, 20000])
+  kKorkelGhosh,
+};
+
+absl::StatusOr<UFLFamily> ParseUFLFamily(absl::string_view name);
+
+struct UFLGeneratorOptions {
+  UFLFamily family = UFLFamily::kEuclidean;
+  int num_facilities = 100;
+  int num_customers = 1000;
+  uint64_t seed = 0;
+  // Open costs are uniform integers in [min_open_cost, max_open_cost]
+  int64_t min_open_cost = 1000;
+  int64_t max_open_cost = 2000;
+  // Euclidean and clustered families: supply cost of a distance of 1 in the
+  // unit square, before rounding
+  double distance_cost = 10000;
+  // Clustered family only
+  int num_clusters = 10;
+  double cluster_stddev = 0.05;
+  // Threads generating supply costs, does not change the instance
+  int num_threads = 1;
+};
+
+UFLProblem GenerateProblem(const UFLGeneratorOptions &options);
+
+// Writes `problem` in ORLIB-cap format, as read by ParseProblem, with zero
+// capacities and demands.
+std::string FormatOrlib(const UFLProblem &problem);
+absl::Status WriteOrlib(const UFLProblem &problem, const std::string &filename);
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_FACILITY_UFL_GENERATOR_H_
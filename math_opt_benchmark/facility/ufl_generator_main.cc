@@ -0,0 +1,70 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Writes a synthetic UFL instance in ORLIB format, e.g.
+//   ufl_generator_main --family=clustered --num_facilities=1000
+//     --num_customers=10000 --seed=7 --output=data/clustered.txt
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "ortools/base/init_google.h"
+#include "absl/flags/flag.h"
+#include "absl/status/statusor.h"
+#include "math_opt_benchmark/facility/ufl_generator.h"
+
+ABSL_FLAG(std::string, family, "euclidean",
+          "Instance family: euclidean, clustered or korkel_ghosh.");
+ABSL_FLAG(int, num_facilities, 100, "Number of facilities.");
+ABSL_FLAG(int, num_customers, 1000, "Number of customers.");
+ABSL_FLAG(uint64_t, seed, 0, "Seed, the same seed gives the same instance.");
+ABSL_FLAG(int64_t, min_open_cost, 1000, "Smallest facility open cost.");
+ABSL_FLAG(int64_t, max_open_cost, 2000, "Largest facility open cost.");
+ABSL_FLAG(double, distance_cost, 10000,
+          "Supply cost of a unit distance in the euclidean and clustered "
+          "families.");
+ABSL_FLAG(int, num_clusters, 10, "Customer clusters of the clustered family.");
+ABSL_FLAG(double, cluster_stddev, 0.05,
+          "Spread of the customers around their cluster center.");
+ABSL_FLAG(int, num_threads, 1, "Threads generating the supply costs.");
+ABSL_FLAG(std::string, output, "", "ORLIB file to write, stdout if empty.");
+
+int main(int argc, char *argv[]) {
+  InitGoogle(argv[0], &argc, &argv, true);
+  math_opt_benchmark::UFLGeneratorOptions options;
+  const absl::StatusOr<math_opt_benchmark::UFLFamily> family =
+      math_opt_benchmark::ParseUFLFamily(absl::GetFlag(FLAGS_family));
+  QCHECK_OK(family.status());
+  options.family = *family;
+  options.num_facilities = absl::GetFlag(FLAGS_num_facilities);
+  options.num_customers = absl::GetFlag(FLAGS_num_customers);
+  options.seed = absl::GetFlag(FLAGS_seed);
+  options.min_open_cost = absl::GetFlag(FLAGS_min_open_cost);
+  options.max_open_cost = absl::GetFlag(FLAGS_max_open_cost);
+  options.distance_cost = absl::GetFlag(FLAGS_distance_cost);
+  options.num_clusters = absl::GetFlag(FLAGS_num_clusters);
+  options.cluster_stddev = absl::GetFlag(FLAGS_cluster_stddev);
+  options.num_threads = absl::GetFlag(FLAGS_num_threads);
+
+  const math_opt_benchmark::UFLProblem problem =
+      math_opt_benchmark::GenerateProblem(options);
+  const std::string output = absl::GetFlag(FLAGS_output);
+  if (output.empty()) {
+    std::cout << math_opt_benchmark::FormatOrlib(problem);
+  } else {
+    QCHECK_OK(math_opt_benchmark::WriteOrlib(problem, output));
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/ufl_generator.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Each;
+using ::testing::ElementsAreArray;
+using ::testing::Ge;
+using ::testing::Le;
+using ::testing::SizeIs;
+
+std::vector<double> Costs(const UFLProblem &problem) {
+  const absl::Span<const double> values = problem.supply_costs.values();
+  return std::vector<double>(values.begin(), values.end());
+}
+
+TEST(ParseUFLFamilyTest, Names) {
+  EXPECT_EQ(*ParseUFLFamily("euclidean"), UFLFamily::kEuclidean);
+  EXPECT_EQ(*ParseUFLFamily("clustered"), UFLFamily::kClustered);
+  EXPECT_EQ(*ParseUFLFamily("korkel_ghosh"), UFLFamily::kKorkelGhosh);
+  EXPECT_EQ(ParseUFLFamily("orlib").status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(GenerateProblemTest, SameSeedSameInstance) {
+  for (const UFLFamily family : {UFLFamily::kEuclidean, UFLFamily::kClustered,
+                                 UFLFamily::kKorkelGhosh}) {
+    UFLGeneratorOptions options;
+    options.family = family;
+    options.num_facilities = 20;
+    options.num_customers = 600;
+    options.seed = 42;
+    const UFLProblem first = GenerateProblem(options);
+    options.num_threads = 4;
+    const UFLProblem threaded = GenerateProblem(options);
+    EXPECT_THAT(threaded.open_costs, ElementsAreArray(first.open_costs));
+    EXPECT_THAT(Costs(threaded), ElementsAreArray(Costs(first)));
+
+    options.seed = 43;
+    const UFLProblem other = GenerateProblem(options);
+    EXPECT_NE(Costs(other), Costs(first));
+  }
+}
+
+TEST(GenerateProblemTest, PinnedInstances) {
+  // Guards against accidental changes to the generator, which would silently
+  // change every instance generated from a recorded seed
+  UFLGeneratorOptions options;
+  options.num_facilities = 3;
+  options.num_customers = 2;
+  options.seed = 1;
+  options.family = UFLFamily::kKorkelGhosh;
+  EXPECT_EQ(FormatOrlib(GenerateProblem(options)),
+            "3 2\n"
+            "0 1931\n0 1568\n0 1196\n"
+            "0\n1604 1863 1990\n"
+            "0\n1154 1651 1034\n");
+  options.family = UFLFamily::kEuclidean;
+  EXPECT_EQ(FormatOrlib(GenerateProblem(options)),
+            "3 2\n"
+            "0 1931\n0 1568\n0 1196\n"
+            "0\n7500 2738 1604\n"
+            "0\n4814 2270 3666\n");
+}
+
+TEST(GenerateProblemTest, CostRanges) {
+  UFLGeneratorOptions options;
+  options.num_facilities = 30;
+  options.num_customers = 100;
+  options.min_open_cost = 100;
+  options.max_open_cost = 200;
+  options.family = UFLFamily::kKorkelGhosh;
+  const UFLProblem korkel_ghosh = GenerateProblem(options);
+  EXPECT_THAT(korkel_ghosh.open_costs, Each(AllOf(Ge(100), Le(200))));
+  EXPECT_THAT(Costs(korkel_ghosh), Each(AllOf(Ge(1000), Le(2000))));
+
+  for (const UFLFamily family :
+       {UFLFamily::kEuclidean, UFLFamily::kClustered}) {
+    options.family = family;
+    const UFLProblem problem = GenerateProblem(options);
+    ASSERT_THAT(problem.open_costs, SizeIs(30));
+    ASSERT_EQ(problem.supply_costs.num_rows(), 100);
+    // Distances in the unit square are at most sqrt(2)
+    EXPECT_THAT(Costs(problem),
+                Each(AllOf(Ge(0), Le(std::ceil(std::sqrt(2.0) * 10000)))));
+    for (const double cost : Costs(problem)) {
+      EXPECT_EQ(cost, std::round(cost));
+    }
+  }
+}
+
+TEST(FormatOrlibTest, RoundTrip) {
+  UFLGeneratorOptions options;
+  options.family = UFLFamily::kClustered;
+  options.num_facilities = 15;
+  options.num_customers = 40;
+  options.seed = 3;
+  const UFLProblem problem = GenerateProblem(options);
+  const absl::StatusOr<UFLProblem> parsed =
+      ParseProblemFromBuffer(FormatOrlib(problem));
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  EXPECT_EQ(parsed->num_facilities, 15);
+  EXPECT_EQ(parsed->num_customers, 40);
+  EXPECT_THAT(parsed->open_costs, ElementsAreArray(problem.open_costs));
+  EXPECT_THAT(Costs(*parsed), ElementsAreArray(Costs(problem)));
+
+  const std::string filename = ::testing::TempDir() + "/generated.txt";
+  ASSERT_TRUE(WriteOrlib(problem, filename).ok());
+  const absl::StatusOr<UFLProblem> from_file = ParseProblemFromFile(filename);
+  ASSERT_TRUE(from_file.ok()) << from_file.status();
+  EXPECT_THAT(Costs(*from_file), ElementsAreArray(Costs(problem)));
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
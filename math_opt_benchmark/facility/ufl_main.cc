@@ -12,19 +12,94 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <fstream>
+#include <string>
+#include <vector>
 
 #include "ortools/base/init_google.h"
 #include "ortools/base/file.h"
+#include "ortools/math_opt/cpp/math_opt.h"
 #include "absl/flags/flag.h"
-#include "absl/random/random.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "math_opt_benchmark/facility/ufl.h"
+#include "math_opt_benchmark/facility/ufl_runner.h"
 
 ABSL_FLAG(std::string, filename, "", "Path to ORLIB problem specification.");
 ABSL_FLAG(std::string, out_dir, "./", "Directory to save protos.");
-ABSL_FLAG(bool, iterative, true, "Solve iteratively");
+ABSL_FLAG(bool, text_output, false,
+          "Save the recorded instance as a text proto for debugging, instead "
+          "of streaming length-delimited binary records to <name>.pb.");
+ABSL_FLAG(operations_research::math_opt::SolverType, solver,
+          operations_research::math_opt::SolverType::kGurobi,
+          "The solver of the Benders master and the direct formulation.");
+ABSL_FLAG(std::string, portfolio, "",
+          "Comma separated solvers raced against --solver on every solve, "
+          "e.g. glop,gscip,gurobi. The first optimal result is used. "
+          "Unavailable solvers are skipped.");
+ABSL_FLAG(std::string, phases, "benders",
+          "Which solvers to run: benders, direct or both.");
+ABSL_FLAG(bool, variable_names, true,
+          "Name the model variables. Disable to build and record large "
+          "instances faster.");
+ABSL_FLAG(bool, lazy_links, false,
+          "Solve the direct formulation from aggregated links, adding the "
+          "violated x_ij <= y_j links to the LP relaxation incrementally.");
+ABSL_FLAG(std::string, input, "",
+          "Directory or glob of ORLIB instances to run in batch mode, instead "
+          "of a single --filename.");
+ABSL_FLAG(int, num_workers, 1, "Instances solved concurrently in batch mode.");
+ABSL_FLAG(std::string, results, "",
+          "File for the batch results, one row per instance. Defaults to "
+          "stdout.");
+ABSL_FLAG(bool, json, false, "Write batch results as JSON instead of CSV.");
+ABSL_FLAG(int, num_threads, 1, "Threads used to generate Benders cuts.");
+ABSL_FLAG(int, num_cut_groups, 1,
+          "Number of Benders epigraph variables, 1 for a single aggregated "
+          "cut per iteration.");
+ABSL_FLAG(int, max_inactive_rounds, 0,
+          "Delete Benders cuts that stay slack for this many master solves, "
+          "0 keeps all cuts.");
+ABSL_FLAG(bool, filter_redundant_cuts, false,
+          "Skip Benders cuts dominated by a cut already in the master.");
+ABSL_FLAG(bool, single_tree, false,
+          "Solve the integer phase once with Benders cuts as lazy "
+          "constraints instead of re-solving the MIP after every cut.");
+ABSL_FLAG(bool, separate_fractional, false,
+          "In single tree mode, also separate fractional node solutions.");
+ABSL_FLAG(bool, warm_start, false,
+          "Hint the integer master with the rounded LP solution and the best "
+          "integer solution found, and set branching priorities from the LP.");
+ABSL_FLAG(bool, incremental_separation, false,
+          "Re-separate only the customers whose critical facility may have "
+          "moved since the previous master solution. Ignored with a "
+          "--core_point.");
+ABSL_FLAG(bool, local_search, false,
+          "Improve every master solution with an add/drop/swap local search "
+          "to tighten the upper bound and hint the integer master.");
+ABSL_FLAG(std::string, core_point, "none",
+          "Generate Pareto-optimal Benders cuts at this core point: none, "
+          "interior (every facility half open) or average (running average "
+          "of the master solutions).");
+ABSL_FLAG(std::string, stabilization, "none",
+          "Stabilize the Benders LP phase: none, in_out (separate between "
+          "the master solution and a stability center) or trust_region (box "
+          "the master around the best solution).");
+ABSL_FLAG(double, in_out_alpha, 0.2,
+          "Weight of the master solution in the in-out separation point.");
+ABSL_FLAG(double, trust_region_radius, 0.5,
+          "Half width of the trust region box around the stability center.");
+ABSL_FLAG(absl::Duration, time_limit, absl::InfiniteDuration(),
+          "Anytime mode: stop Benders after this long and report the best "
+          "solution found.");
+ABSL_FLAG(double, relative_gap, 0.0,
+          "Anytime mode: stop Benders once the best solution is within this "
+          "relative gap of the lower bound, 0 to solve to optimality.");
+ABSL_FLAG(double, lp_time_fraction, 0.25,
+          "Share of --time_limit spent in the Benders LP phase.");
+ABSL_FLAG(std::string, presort_cache_dir, "",
+          "Directory caching the per-customer sorted supply costs between "
+          "runs, keyed by an instance hash. Empty disables the cache.");
 
 namespace math_opt = operations_research::math_opt;
 
@@ -48,25 +123,62 @@ void PrintORLIB(const UFLSolution& solution) {
   printf("%.5f\n", solution.objective_value);
 }
 
-void UFLMain(const std::string& filename, const std::string& out_dir,
-             bool iterative) {
-  std::string contents;
-  CHECK(file::GetContents(filename, &contents, file::Defaults()).ok());
-  UFLProblem problem = ParseProblem(contents);
-  if (iterative) {
-    UFLBenders solver(problem);
-    UFLSolution solution = solver.Solve();
+void PrintStats(const UFLBendersStats& stats) {
+  std::cout << "Presort time: " << stats.presort_time << std::endl;
+  std::cout << "LP iterations: " << stats.lp_iterations
+            << ", time: " << stats.lp_time << std::endl;
+  std::cout << "Integer iterations: " << stats.integer_iterations
+            << ", time: " << stats.integer_time << std::endl;
+  std::cout << "Cuts added: " << stats.num_cuts
+            << ", purged: " << stats.num_purged_cuts
+            << ", rejected: " << stats.num_rejected_cuts << std::endl;
+  std::cout << "LP wins: "
+            << absl::StrJoin(stats.lp_wins, ",", absl::PairFormatter("="))
+            << std::endl;
+  std::cout << "Integer wins: "
+            << absl::StrJoin(stats.integer_wins, ",", absl::PairFormatter("="))
+            << std::endl;
+  std::cout << "Incremental separations: "
+            << stats.num_incremental_separations
+            << ", revisited customers: " << stats.num_revisited_customers
+            << std::endl;
+  std::cout << "Local search incumbents: " << stats.num_local_search_incumbents
+            << ", time: " << stats.local_search_time << std::endl;
+}
 
-    UFLSolver direct_solver(math_opt::SolverType::kGurobi, problem, false);
-    UFLSolution direct_solution = direct_solver.Solve();
+void UFLMain(const std::string& filename, const UFLRunOptions& options) {
+  const UFLRunResult result = RunUFLInstance(filename, options);
+  CHECK_OK(result.status);
+  if (options.run_benders) {
+    std::cout << "Status: " << UFLSolveStatusName(result.benders_solution.status)
+              << ", lower bound: " << result.benders_solution.lower_bound
+              << std::endl;
+    PrintStats(result.benders_stats);
+    std::cout << SummarizeIterations(result.benders_iterations);
+  }
+  if (options.run_direct) {
+    PrintORLIB(result.direct_solution);
+  }
+}
 
-    std::ofstream f(out_dir + filename.substr(filename.find_last_of('/')));
-    f << absl::StrCat(solver.GetModel());
-    f.close();
+void UFLBatchMain(const std::string& input, const UFLRunOptions& options,
+                  int num_workers, const std::string& results_file,
+                  bool json) {
+  absl::StatusOr<std::vector<std::string>> filenames =
+      ExpandInstancePaths(input);
+  CHECK(filenames.ok()) << filenames.status();
+  const std::vector<UFLRunResult> results =
+      RunUFLBatch(*filenames, options, num_workers);
+  const std::string output =
+      json ? RunResultsToJson(results) : RunResultsToCsv(results);
+  if (results_file.empty()) {
+    std::cout << output;
   } else {
-    UFLSolver direct_solver(math_opt::SolverType::kGurobi, problem, false);
-    UFLSolution direct_solution = direct_solver.Solve();
-    PrintORLIB(direct_solution);
+    CHECK_OK(file::SetContents(results_file, output, file::Defaults()));
+  }
+  for (const UFLRunResult& result : results) {
+    LOG_IF(WARNING, !result.status.ok())
+        << result.filename << ": " << result.status;
   }
 }
 
@@ -74,9 +186,60 @@ void UFLMain(const std::string& filename, const std::string& out_dir,
 
 int main(int argc, char *argv[]) {
   InitGoogle(argv[0], &argc, &argv, true);
-  std::string filename = absl::GetFlag(FLAGS_filename);
-  std::string out_dir = absl::GetFlag(FLAGS_out_dir);
+  math_opt_benchmark::UFLRunOptions options;
+  const std::string phases = absl::GetFlag(FLAGS_phases);
+  CHECK(phases == "benders" || phases == "direct" || phases == "both")
+      << "Unknown --phases: " << phases;
+  options.run_benders = phases != "direct";
+  options.run_direct = phases != "benders";
+  options.solver_type = absl::GetFlag(FLAGS_solver);
+  absl::StatusOr<std::vector<math_opt::SolverType>> portfolio =
+      math_opt_benchmark::ParsePortfolio(absl::GetFlag(FLAGS_portfolio));
+  CHECK(portfolio.ok()) << portfolio.status();
+  options.portfolio = *std::move(portfolio);
+  options.out_dir = absl::GetFlag(FLAGS_out_dir);
+  options.text_output = absl::GetFlag(FLAGS_text_output);
+  options.variable_names = absl::GetFlag(FLAGS_variable_names);
+  options.lazy_links = absl::GetFlag(FLAGS_lazy_links);
+  options.benders.num_threads = absl::GetFlag(FLAGS_num_threads);
+  options.benders.num_cut_groups = absl::GetFlag(FLAGS_num_cut_groups);
+  options.benders.single_tree = absl::GetFlag(FLAGS_single_tree);
+  options.benders.separate_fractional =
+      absl::GetFlag(FLAGS_separate_fractional);
+  options.benders.warm_start = absl::GetFlag(FLAGS_warm_start);
+  options.benders.incremental_separation =
+      absl::GetFlag(FLAGS_incremental_separation);
+  options.benders.local_search = absl::GetFlag(FLAGS_local_search);
+  absl::StatusOr<math_opt_benchmark::CorePoint> core_point =
+      math_opt_benchmark::ParseCorePoint(absl::GetFlag(FLAGS_core_point));
+  CHECK(core_point.ok()) << core_point.status();
+  options.benders.core_point = *core_point;
+  absl::StatusOr<math_opt_benchmark::Stabilization> stabilization =
+      math_opt_benchmark::ParseStabilization(
+          absl::GetFlag(FLAGS_stabilization));
+  CHECK(stabilization.ok()) << stabilization.status();
+  options.benders.stabilization = *stabilization;
+  options.benders.in_out_alpha = absl::GetFlag(FLAGS_in_out_alpha);
+  options.benders.trust_region_radius =
+      absl::GetFlag(FLAGS_trust_region_radius);
+  options.benders.time_limit = absl::GetFlag(FLAGS_time_limit);
+  options.benders.relative_gap = absl::GetFlag(FLAGS_relative_gap);
+  options.benders.lp_time_fraction = absl::GetFlag(FLAGS_lp_time_fraction);
+  options.benders.presort_cache_dir = absl::GetFlag(FLAGS_presort_cache_dir);
+  options.benders.master.max_inactive_rounds =
+      absl::GetFlag(FLAGS_max_inactive_rounds);
+  options.benders.master.filter_redundant_cuts =
+      absl::GetFlag(FLAGS_filter_redundant_cuts);
+
+  const std::string input = absl::GetFlag(FLAGS_input);
+  if (!input.empty()) {
+    math_opt_benchmark::UFLBatchMain(input, options,
+                                     absl::GetFlag(FLAGS_num_workers),
+                                     absl::GetFlag(FLAGS_results),
+                                     absl::GetFlag(FLAGS_json));
+    return 0;
+  }
+  const std::string filename = absl::GetFlag(FLAGS_filename);
   std::cerr << filename << std::endl;
-  bool iterative = absl::GetFlag(FLAGS_iterative);
-  math_opt_benchmark::UFLMain(filename, out_dir, iterative);
+  math_opt_benchmark::UFLMain(filename, options);
 }
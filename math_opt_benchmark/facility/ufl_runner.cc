@@ -0,0 +1,366 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/ufl_runner.h"
+
+#include <glob.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_replace.h"
+#include "absl/time/clock.h"
+#include "math_opt_benchmark/facility/parallel_for.h"
+#include "math_opt_benchmark/proto/benchmark_recorder.h"
+#include "ortools/base/file.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+std::string Basename(const std::string &filename) {
+  const std::size_t slash = filename.find_last_of('/');
+  return slash == std::string::npos ? filename : filename.substr(slash + 1);
+}
+
+std::string JoinPath(const std::string &dir, const std::string &name) {
+  if (dir.empty() || dir.back() == '/') {
+    return absl::StrCat(dir, name);
+  }
+  return absl::StrCat(dir, "/", name);
+}
+
+bool IsDirectory(const std::string &path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool IsRegularFile(const std::string &path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+// Quotes a CSV field if it contains a separator, quote or line break
+std::string CsvField(const std::string &value) {
+  if (value.find_first_of(",\"\r\n") == std::string::npos) {
+    return value;
+  }
+  return absl::StrCat("\"", absl::StrReplaceAll(value, {{"\"", "\"\""}}),
+                      "\"");
+}
+
+// A JSON string literal holding value
+std::string JsonString(const std::string &value) {
+  std::string json = "\"";
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        json += "\\\"";
+        break;
+      case '\\':
+        json += "\\\\";
+        break;
+      case '\n':
+        json += "\\n";
+        break;
+      case '\t':
+        json += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(&json, "\\u%04x", static_cast<int>(c));
+        } else {
+          json += c;
+        }
+    }
+  }
+  json += "\"";
+  return json;
+}
+
+// Phases that did not run report `missing` instead of an objective
+std::string FormatObjective(bool ran, const UFLSolution &solution,
+                            const std::string &missing) {
+  // A solve stopped before finding a solution has no objective
+  return ran && !solution.open_values.empty()
+             ? absl::StrCat(solution.objective_value)
+             : missing;
+}
+
+std::string FormatStatus(bool ran, const UFLSolution &solution,
+                         const std::string &missing,
+                         const std::string &quote = "") {
+  return ran ? absl::StrCat(quote, UFLSolveStatusName(solution.status), quote)
+             : missing;
+}
+
+std::string FormatLowerBound(bool ran, const UFLSolution &solution,
+                             const std::string &missing) {
+  return ran && std::isfinite(solution.lower_bound)
+             ? absl::StrCat(solution.lower_bound)
+             : missing;
+}
+
+// Opens the stream for out_file, or returns null if the recording is written
+// as text once the solve is done.
+absl::StatusOr<std::unique_ptr<StreamRecorder>> OpenRecorder(
+    const UFLRunOptions &options, const std::string &out_file) {
+  if (options.text_output) {
+    return nullptr;
+  }
+  return StreamRecorder::Open(out_file + ".pb");
+}
+
+template <typename Solver>
+absl::Status FinishRecording(const UFLRunOptions &options,
+                             const std::string &out_file, Solver &solver,
+                             StreamRecorder *recorder) {
+  if (options.text_output) {
+    return file::SetTextProto(out_file, solver.GetModel(), file::Defaults());
+  }
+  return recorder->Close();
+}
+
+void RunBenders(const UFLProblem &problem, const std::string &filename,
+                const UFLRunOptions &options, UFLRunResult &result) {
+  const std::string out_file = JoinPath(options.out_dir, Basename(filename));
+  const bool record = !options.out_dir.empty();
+  std::unique_ptr<StreamRecorder> recorder;
+  UFLBendersOptions benders_options = options.benders;
+  benders_options.master.variable_names = options.variable_names;
+  benders_options.master.portfolio = options.portfolio;
+  if (record) {
+    absl::StatusOr<std::unique_ptr<StreamRecorder>> opened =
+        OpenRecorder(options, out_file);
+    if (!opened.ok()) {
+      result.status = opened.status();
+      return;
+    }
+    recorder = *std::move(opened);
+    benders_options.master.recorder = recorder.get();
+  }
+
+  absl::Time start = absl::Now();
+  UFLBenders solver(problem, options.solver_type, benders_options);
+  result.benders_build_time = absl::Now() - start;
+  start = absl::Now();
+  result.benders_solution = solver.Solve();
+  result.benders_solve_time = absl::Now() - start;
+  result.benders_stats = solver.stats();
+  result.benders_iterations = solver.iterations();
+  result.ran_benders = true;
+  result.core_point = options.benders.core_point;
+  result.stabilization = options.benders.stabilization;
+
+  if (!record) {
+    return;
+  }
+  start = absl::Now();
+  result.status = FinishRecording(options, out_file, solver, recorder.get());
+  result.record_time = absl::Now() - start;
+}
+
+// Only the lazy links formulation changes between solves, so only it is
+// recorded, as <instance name>.links.pb
+void RunDirect(const UFLProblem &problem, const std::string &filename,
+               const UFLRunOptions &options, UFLRunResult &result) {
+  const std::string out_file =
+      JoinPath(options.out_dir, Basename(filename) + ".links");
+  const bool record = options.lazy_links && !options.out_dir.empty();
+  std::unique_ptr<StreamRecorder> recorder;
+  UFLSolverOptions direct_options;
+  direct_options.variable_names = options.variable_names;
+  direct_options.lazy_links = options.lazy_links;
+  direct_options.portfolio = options.portfolio;
+  if (record) {
+    absl::StatusOr<std::unique_ptr<StreamRecorder>> opened =
+        OpenRecorder(options, out_file);
+    if (!opened.ok()) {
+      result.status = opened.status();
+      return;
+    }
+    recorder = *std::move(opened);
+    direct_options.recorder = recorder.get();
+  }
+
+  absl::Time start = absl::Now();
+  UFLSolver solver(options.solver_type, problem, /*iterative=*/false,
+                   direct_options);
+  result.direct_build_time = absl::Now() - start;
+  result.direct_model_size = solver.initial_model_size();
+  start = absl::Now();
+  result.direct_solution = solver.Solve();
+  result.direct_solve_time = absl::Now() - start;
+  result.num_lazy_links = solver.num_lazy_links();
+  result.ran_direct = true;
+
+  if (record) {
+    start = absl::Now();
+    const absl::Status status =
+        FinishRecording(options, out_file, solver, recorder.get());
+    result.record_time += absl::Now() - start;
+    result.status.Update(status);
+  }
+}
+
+}  // namespace
+
+UFLRunResult RunUFLInstance(const std::string &filename,
+                            const UFLRunOptions &options) {
+  UFLRunResult result;
+  result.filename = filename;
+  const absl::Time start = absl::Now();
+  absl::StatusOr<UFLProblem> problem = ParseProblemFromFile(filename);
+  result.parse_time = absl::Now() - start;
+  if (!problem.ok()) {
+    result.status = problem.status();
+    return result;
+  }
+  result.num_facilities = problem->num_facilities;
+  result.num_customers = problem->num_customers;
+  if (options.run_benders) {
+    RunBenders(*problem, filename, options, result);
+  }
+  if (options.run_direct) {
+    RunDirect(*problem, filename, options, result);
+  }
+  return result;
+}
+
+std::vector<UFLRunResult> RunUFLBatch(const std::vector<std::string> &filenames,
+                                      const UFLRunOptions &options,
+                                      int num_workers) {
+  std::vector<UFLRunResult> results(filenames.size());
+  ParallelFor(num_workers, filenames.size(), [&](int i) {
+    results[i] = RunUFLInstance(filenames[i], options);
+  });
+  return results;
+}
+
+absl::StatusOr<std::vector<std::string>> ExpandInstancePaths(
+    const std::string &pattern) {
+  const std::string expanded =
+      IsDirectory(pattern) ? JoinPath(pattern, "*") : pattern;
+  glob_t matches;
+  const int error = glob(expanded.c_str(), 0, nullptr, &matches);
+  if (error == GLOB_NOMATCH) {
+    globfree(&matches);
+    return absl::NotFoundError(absl::StrCat("No files match ", pattern));
+  }
+  if (error != 0) {
+    globfree(&matches);
+    return absl::InternalError(absl::StrCat("Failed to expand ", pattern));
+  }
+  std::vector<std::string> filenames;
+  for (std::size_t i = 0; i < matches.gl_pathc; i++) {
+    if (IsRegularFile(matches.gl_pathv[i])) {
+      filenames.push_back(matches.gl_pathv[i]);
+    }
+  }
+  globfree(&matches);
+  std::sort(filenames.begin(), filenames.end());
+  return filenames;
+}
+
+std::string RunResultsToCsv(const std::vector<UFLRunResult> &results) {
+  std::string csv =
+      "instance,status,num_facilities,num_customers,parse_seconds,"
+      "benders_build_seconds,benders_solve_seconds,record_seconds,"
+      "core_point,stabilization,lp_iterations,integer_iterations,lp_seconds,"
+      "integer_seconds,num_cuts,benders_status,benders_lower_bound,"
+      "benders_objective,"
+      "direct_build_seconds,direct_nonzeros,direct_model_bytes,"
+      "direct_solve_seconds,num_lazy_links,direct_objective\n";
+  for (const UFLRunResult &result : results) {
+    absl::StrAppend(
+        &csv, CsvField(result.filename), ",",
+        absl::StatusCodeToString(result.status.code()), ",",
+        result.num_facilities, ",", result.num_customers, ",",
+        absl::ToDoubleSeconds(result.parse_time), ",",
+        absl::ToDoubleSeconds(result.benders_build_time), ",",
+        absl::ToDoubleSeconds(result.benders_solve_time), ",",
+        absl::ToDoubleSeconds(result.record_time), ",",
+        CorePointName(result.core_point), ",",
+        StabilizationName(result.stabilization), ",",
+        result.benders_stats.lp_iterations, ",",
+        result.benders_stats.integer_iterations, ",",
+        absl::ToDoubleSeconds(result.benders_stats.lp_time), ",",
+        absl::ToDoubleSeconds(result.benders_stats.integer_time), ",",
+        result.benders_stats.num_cuts, ",",
+        FormatStatus(result.ran_benders, result.benders_solution, ""), ",",
+        FormatLowerBound(result.ran_benders, result.benders_solution, ""),
+        ",",
+        FormatObjective(result.ran_benders, result.benders_solution, ""), ",",
+        absl::ToDoubleSeconds(result.direct_build_time), ",",
+        result.direct_model_size.num_nonzeros, ",",
+        result.direct_model_size.bytes, ",",
+        absl::ToDoubleSeconds(result.direct_solve_time), ",",
+        result.num_lazy_links, ",",
+        FormatObjective(result.ran_direct, result.direct_solution, ""), "\n");
+  }
+  return csv;
+}
+
+std::string RunResultsToJson(const std::vector<UFLRunResult> &results) {
+  std::string json = "[";
+  for (int i = 0; i < results.size(); i++) {
+    const UFLRunResult &result = results[i];
+    absl::StrAppend(
+        &json, i == 0 ? "\n" : ",\n",
+        "  {\"instance\": ", JsonString(result.filename), ", \"status\": \"",
+        absl::StatusCodeToString(result.status.code()),
+        "\", \"num_facilities\": ", result.num_facilities,
+        ", \"num_customers\": ", result.num_customers,
+        ", \"parse_seconds\": ", absl::ToDoubleSeconds(result.parse_time),
+        ", \"benders_build_seconds\": ",
+        absl::ToDoubleSeconds(result.benders_build_time),
+        ", \"benders_solve_seconds\": ",
+        absl::ToDoubleSeconds(result.benders_solve_time),
+        ", \"record_seconds\": ", absl::ToDoubleSeconds(result.record_time),
+        ", \"core_point\": \"", CorePointName(result.core_point), "\"",
+        ", \"stabilization\": \"", StabilizationName(result.stabilization),
+        "\"",
+        ", \"lp_iterations\": ", result.benders_stats.lp_iterations,
+        ", \"integer_iterations\": ", result.benders_stats.integer_iterations,
+        ", \"lp_seconds\": ",
+        absl::ToDoubleSeconds(result.benders_stats.lp_time),
+        ", \"integer_seconds\": ",
+        absl::ToDoubleSeconds(result.benders_stats.integer_time),
+        ", \"num_cuts\": ", result.benders_stats.num_cuts,
+        ", \"benders_status\": ",
+        FormatStatus(result.ran_benders, result.benders_solution, "null",
+                     "\""),
+        ", \"benders_lower_bound\": ",
+        FormatLowerBound(result.ran_benders, result.benders_solution, "null"),
+        ", \"benders_objective\": ",
+        FormatObjective(result.ran_benders, result.benders_solution, "null"),
+        ", \"direct_build_seconds\": ",
+        absl::ToDoubleSeconds(result.direct_build_time),
+        ", \"direct_nonzeros\": ", result.direct_model_size.num_nonzeros,
+        ", \"direct_model_bytes\": ", result.direct_model_size.bytes,
+        ", \"direct_solve_seconds\": ",
+        absl::ToDoubleSeconds(result.direct_solve_time),
+        ", \"num_lazy_links\": ", result.num_lazy_links,
+        ", \"direct_objective\": ",
+        FormatObjective(result.ran_direct, result.direct_solution, "null"), "}");
+  }
+  absl::StrAppend(&json, "\n]\n");
+  return json;
+}
+
+}  // namespace math_opt_benchmark
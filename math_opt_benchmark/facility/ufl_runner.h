@@ -0,0 +1,108 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs the UFL solvers over one or many ORLIB instances and collects timings.
+
+#ifndef MATH_OPT_BENCHMARK_FACILITY_UFL_RUNNER_H_
+#define MATH_OPT_BENCHMARK_FACILITY_UFL_RUNNER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "math_opt_benchmark/facility/ufl.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace math_opt_benchmark {
+
+struct UFLRunOptions {
+  bool run_benders = true;
+  bool run_direct = false;
+  operations_research::math_opt::SolverType solver_type =
+      operations_research::math_opt::SolverType::kGurobi;
+  // Solvers raced against solver_type by both the Benders master and the
+  // direct formulation, see UFLSolverOptions::portfolio.
+  std::vector<operations_research::math_opt::SolverType> portfolio;
+  UFLBendersOptions benders;
+  // Overrides the variable_names option of both the Benders master and the
+  // direct formulation.
+  bool variable_names = true;
+  // Solve the direct formulation with lazily separated links, see
+  // UFLSolverOptions::lazy_links.
+  bool lazy_links = false;
+  // Directory where the Benders BenchmarkInstance is recorded, as
+  // <out_dir>/<instance name>.pb, or as text if text_output. Empty to skip.
+  // With lazy_links the direct solves are recorded as well, to
+  // <out_dir>/<instance name>.links.pb.
+  std::string out_dir;
+  bool text_output = false;
+};
+
+struct UFLRunResult {
+  std::string filename;
+  // Not ok if the instance could not be read or the recording not written
+  absl::Status status;
+  int num_facilities = 0;
+  int num_customers = 0;
+  absl::Duration parse_time;
+  // Closing or writing the recordings, see UFLRunOptions::out_dir
+  absl::Duration record_time;
+
+  // Benders, if run
+  bool ran_benders = false;
+  // Cut selection and stabilization, so runs with different settings can be
+  // compared side by side
+  CorePoint core_point = CorePoint::kNone;
+  Stabilization stabilization = Stabilization::kNone;
+  absl::Duration benders_build_time;
+  absl::Duration benders_solve_time;
+  UFLBendersStats benders_stats;
+  std::vector<IterationStats> benders_iterations;
+  UFLSolution benders_solution;
+
+  // Direct formulation, if run
+  bool ran_direct = false;
+  absl::Duration direct_build_time;
+  UFLModelSize direct_model_size;
+  absl::Duration direct_solve_time;
+  int num_lazy_links = 0;
+  UFLSolution direct_solution;
+};
+
+UFLRunResult RunUFLInstance(const std::string &filename,
+                            const UFLRunOptions &options);
+
+// Runs every instance on up to num_workers threads, results are in the order
+// of `filenames`.
+std::vector<UFLRunResult> RunUFLBatch(const std::vector<std::string> &filenames,
+                                      const UFLRunOptions &options,
+                                      int num_workers);
+
+// Returns the sorted files matching a glob pattern, or all files in `pattern`
+// if it is a directory.
+absl::StatusOr<std::vector<std::string>> ExpandInstancePaths(
+    const std::string &pattern);
+
+// One row per instance, with a header line. Objectives of phases that did not
+// run are empty.
+std::string RunResultsToCsv(const std::vector<UFLRunResult> &results);
+
+// A JSON array with one object per instance
+std::string RunResultsToJson(const std::vector<UFLRunResult> &results);
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_FACILITY_UFL_RUNNER_H_
@@ -0,0 +1,183 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/facility/ufl_runner.h"
+
+#include <sys/stat.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "math_opt_benchmark/proto/benchmark_recorder.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+namespace math_opt = ::operations_research::math_opt;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+using ::testing::StartsWith;
+
+constexpr double kTolerance = 1e-5;
+
+// Two facilities, two customers, the optimum opens facility 1 at cost 2.
+constexpr char kInstance[] =
+    "2 2\n"
+    "cap 1\n"
+    "cap 0.5\n"
+    "demand\n"
+    "1 0.5\n"
+    "demand\n"
+    "0.5 1\n";
+
+std::string MakeInstanceDir(const std::string &name) {
+  const std::string dir = ::testing::TempDir() + "/" + name;
+  mkdir(dir.c_str(), 0755);
+  return dir;
+}
+
+void WriteFile(const std::string &filename, const std::string &contents) {
+  std::ofstream f(filename);
+  f << contents;
+}
+
+TEST(ExpandInstancePathsTest, DirectoryAndGlob) {
+  const std::string dir = MakeInstanceDir("ufl_runner_expand");
+  WriteFile(dir + "/b.txt", kInstance);
+  WriteFile(dir + "/a.txt", kInstance);
+  WriteFile(dir + "/c.opt", "");
+  mkdir((dir + "/subdir").c_str(), 0755);
+
+  const absl::StatusOr<std::vector<std::string>> all = ExpandInstancePaths(dir);
+  ASSERT_TRUE(all.ok()) << all.status();
+  EXPECT_THAT(*all,
+              ElementsAre(dir + "/a.txt", dir + "/b.txt", dir + "/c.opt"));
+
+  const absl::StatusOr<std::vector<std::string>> txt =
+      ExpandInstancePaths(dir + "/*.txt");
+  ASSERT_TRUE(txt.ok()) << txt.status();
+  EXPECT_THAT(*txt, ElementsAre(dir + "/a.txt", dir + "/b.txt"));
+
+  EXPECT_EQ(ExpandInstancePaths(dir + "/*.missing").status().code(),
+            absl::StatusCode::kNotFound);
+}
+
+TEST(RunUFLInstanceTest, MissingFile) {
+  UFLRunOptions options;
+  options.out_dir = "";
+  const UFLRunResult result =
+      RunUFLInstance(::testing::TempDir() + "/missing.txt", options);
+  EXPECT_FALSE(result.status.ok());
+  EXPECT_FALSE(result.ran_benders);
+  EXPECT_FALSE(result.ran_direct);
+}
+
+TEST(RunUFLInstanceTest, BothPhases) {
+  const std::string dir = MakeInstanceDir("ufl_runner_both");
+  const std::string filename = dir + "/two.txt";
+  WriteFile(filename, kInstance);
+  UFLRunOptions options;
+  options.solver_type = math_opt::SolverType::kGscip;
+  options.run_direct = true;
+  options.out_dir = dir;
+
+  const UFLRunResult result = RunUFLInstance(filename, options);
+  ASSERT_TRUE(result.status.ok()) << result.status;
+  EXPECT_EQ(result.num_facilities, 2);
+  EXPECT_EQ(result.num_customers, 2);
+  ASSERT_TRUE(result.ran_benders);
+  ASSERT_TRUE(result.ran_direct);
+  EXPECT_NEAR(result.benders_solution.objective_value, 2.0, kTolerance);
+  EXPECT_NEAR(result.direct_solution.objective_value, 2.0, kTolerance);
+  EXPECT_GT(result.benders_stats.lp_iterations, 0);
+
+  const absl::StatusOr<BenchmarkInstance> recorded =
+      ReadBenchmarkStream(filename + ".pb");
+  ASSERT_TRUE(recorded.ok()) << recorded.status();
+  EXPECT_EQ(recorded->objectives_size(), recorded->model_updates_size() + 1);
+}
+
+TEST(RunUFLInstanceTest, RecordsLazyLinks) {
+  const std::string dir = MakeInstanceDir("ufl_runner_links");
+  const std::string filename = dir + "/two.txt";
+  WriteFile(filename, kInstance);
+  UFLRunOptions options;
+  options.solver_type = math_opt::SolverType::kGscip;
+  options.run_benders = false;
+  options.run_direct = true;
+  options.lazy_links = true;
+  options.out_dir = dir;
+
+  const UFLRunResult result = RunUFLInstance(filename, options);
+  ASSERT_TRUE(result.status.ok()) << result.status;
+  EXPECT_NEAR(result.direct_solution.objective_value, 2.0, kTolerance);
+  const absl::StatusOr<BenchmarkInstance> recorded =
+      ReadBenchmarkStream(filename + ".links.pb");
+  ASSERT_TRUE(recorded.ok()) << recorded.status();
+  EXPECT_EQ(recorded->objectives_size(), recorded->model_updates_size() + 1);
+}
+
+TEST(RunUFLBatchTest, OnlyRequestedPhases) {
+  const std::string dir = MakeInstanceDir("ufl_runner_batch");
+  std::vector<std::string> filenames;
+  for (const std::string name : {"a.txt", "b.txt", "c.txt"}) {
+    filenames.push_back(dir + "/" + name);
+    WriteFile(filenames.back(), kInstance);
+  }
+  filenames.push_back(dir + "/missing.txt");
+  UFLRunOptions options;
+  options.solver_type = math_opt::SolverType::kGscip;
+  options.run_benders = false;
+  options.run_direct = true;
+  options.out_dir = "";
+
+  const std::vector<UFLRunResult> results =
+      RunUFLBatch(filenames, options, /*num_workers=*/2);
+  ASSERT_THAT(results, SizeIs(4));
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(results[i].filename, filenames[i]);
+    EXPECT_TRUE(results[i].status.ok()) << results[i].status;
+    EXPECT_FALSE(results[i].ran_benders);
+    EXPECT_NEAR(results[i].direct_solution.objective_value, 2.0, kTolerance);
+  }
+  EXPECT_FALSE(results[3].status.ok());
+
+  const std::string csv = RunResultsToCsv(results);
+  EXPECT_THAT(csv, StartsWith("instance,status,"));
+  EXPECT_THAT(csv, HasSubstr(dir + "/a.txt,OK,2,2,"));
+  EXPECT_THAT(csv, HasSubstr(dir + "/missing.txt,NOT_FOUND,"));
+  const std::string json = RunResultsToJson(results);
+  EXPECT_THAT(json, HasSubstr("\"benders_objective\": null"));
+  EXPECT_THAT(json, HasSubstr("\"direct_objective\": 2"));
+}
+
+TEST(RunResultsTest, EscapesFilenames) {
+  UFLRunResult result;
+  result.filename = "dir,1/\"quoted\"\\name\n.txt";
+  const std::string csv = RunResultsToCsv({result});
+  EXPECT_THAT(csv, HasSubstr("\n\"dir,1/\"\"quoted\"\"\\name\n.txt\",OK,"));
+  const std::string json = RunResultsToJson({result});
+  EXPECT_THAT(json, HasSubstr("\"instance\": \"dir,1/\\\"quoted\\\"\\\\name"
+                              "\\n.txt\", \"status\""));
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
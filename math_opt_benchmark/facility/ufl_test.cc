@@ -14,11 +14,25 @@
 
 #include "math_opt_benchmark/facility/ufl.h"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <sstream>
+#include <string>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "math_opt_benchmark/proto/benchmark_recorder.h"
+#include "math_opt_benchmark/replay/replay.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
 namespace math_opt_benchmark {
@@ -26,11 +40,17 @@ namespace {
 
 namespace math_opt = ::operations_research::math_opt;
 using ::testing::DoubleNear;
+using ::testing::Each;
 using ::testing::ElementsAreArray;
 using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Not;
 using ::testing::Pointwise;
+using ::testing::SizeIs;
 
 constexpr double kTolerance = 1e-5;
+constexpr double kInf = std::numeric_limits<double>::infinity();
 
 TEST(ParseTest, SmallInstance) {
   const std::string str(
@@ -60,6 +80,138 @@ TEST(ParseTest, SmallInstance) {
   }
 }
 
+TEST(ParseTest, BufferMatchesStringParser) {
+  const std::string str(
+      "2 2\n"
+      "cap 1.5\n"
+      "cap 2.5\n"
+      "7\n"
+      "1 2\n"
+      "9\n"
+      "3\n"
+      "4\n");
+  const absl::StatusOr<UFLProblem> problem = ParseProblemFromBuffer(str);
+  ASSERT_TRUE(problem.ok()) << problem.status();
+  EXPECT_THAT(problem->open_costs, ElementsAreArray({1.5, 2.5}));
+  EXPECT_THAT(problem->supply_costs[0], ElementsAreArray({1.0, 2.0}));
+  EXPECT_THAT(problem->supply_costs[1], ElementsAreArray({3.0, 4.0}));
+}
+
+TEST(ParseTest, TruncatedInput) {
+  const std::string str(
+      "2 1\n"
+      "cap 10\n"
+      "cap 20\n"
+      "demand\n"
+      "1\n");
+  const absl::StatusOr<UFLProblem> problem = ParseProblemFromBuffer(str);
+  EXPECT_EQ(problem.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(problem.status().message(), HasSubstr("Truncated"));
+}
+
+TEST(ParseTest, MalformedCost) {
+  const std::string str(
+      "2 1\n"
+      "cap 10\n"
+      "cap 20\n"
+      "demand\n"
+      "1 abc\n");
+  const absl::StatusOr<UFLProblem> problem = ParseProblemFromBuffer(str);
+  EXPECT_EQ(problem.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(problem.status().message(), HasSubstr("line 5"));
+}
+
+TEST(ParseTest, FromFile) {
+  const std::string filename = ::testing::TempDir() + "/ufl_parse_test.txt";
+  {
+    std::ofstream f(filename);
+    f << "1 1\ncap 3\ndemand\n4\n";
+  }
+  const absl::StatusOr<UFLProblem> problem = ParseProblemFromFile(filename);
+  ASSERT_TRUE(problem.ok()) << problem.status();
+  EXPECT_THAT(problem->open_costs, ElementsAreArray({3.0}));
+  EXPECT_THAT(problem->supply_costs[0], ElementsAreArray({4.0}));
+  EXPECT_FALSE(ParseProblemFromFile(filename + ".missing").ok());
+}
+
+TEST(BuildDirectModelProtoTest, TwoByTwo) {
+  UFLProblem problem;
+  problem.num_facilities = 2;
+  problem.num_customers = 2;
+  problem.open_costs = {1.0, 0.5};
+  problem.supply_costs = {{1.0, 0.5}, {0.5, 1.0}};
+  const math_opt::ModelProto model = BuildDirectModelProto(problem, true);
+  EXPECT_THAT(model.variables().ids(), ElementsAreArray({0, 1, 2, 3, 4, 5}));
+  EXPECT_THAT(model.variables().integers(),
+              ElementsAreArray({true, true, false, false, false, false}));
+  EXPECT_THAT(model.variables().names(),
+              ElementsAreArray({"y0", "y1", "x0,0", "x0,1", "x1,0", "x1,1"}));
+  EXPECT_FALSE(model.objective().maximize());
+  EXPECT_THAT(model.objective().linear_coefficients().values(),
+              ElementsAreArray({1.0, 0.5, 1.0, 0.5, 0.5, 1.0}));
+  // 2 assignment rows and 4 links, no rows for the bounds of y
+  EXPECT_THAT(model.linear_constraints().lower_bounds(),
+              ElementsAreArray({1.0, 1.0, -kInf, -kInf, -kInf, -kInf}));
+  EXPECT_THAT(model.linear_constraints().upper_bounds(),
+              ElementsAreArray({1.0, 1.0, 0.0, 0.0, 0.0, 0.0}));
+  const math_opt::SparseDoubleMatrixProto& matrix =
+      model.linear_constraint_matrix();
+  EXPECT_THAT(matrix.row_ids(),
+              ElementsAreArray({0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5}));
+  EXPECT_THAT(matrix.column_ids(),
+              ElementsAreArray({2, 3, 4, 5, 0, 2, 1, 3, 0, 4, 1, 5}));
+  EXPECT_THAT(matrix.coefficients(),
+              ElementsAreArray({1, 1, 1, 1, -1, 1, -1, 1, -1, 1, -1, 1}));
+
+  EXPECT_THAT(BuildDirectModelProto(problem, false).variables().names(),
+              IsEmpty());
+}
+
+TEST(BuildDirectModelProtoTest, AggregatedLinks) {
+  UFLProblem problem;
+  problem.num_facilities = 2;
+  problem.num_customers = 3;
+  problem.open_costs = {1.0, 0.5};
+  problem.supply_costs = {{1.0, 0.5}, {0.5, 1.0}, {2.0, 2.0}};
+  const math_opt::ModelProto model =
+      BuildDirectModelProto(problem, false, /*lazy_links=*/true);
+  EXPECT_THAT(model.variables().integers(), Each(false));
+  // 3 assignment rows and one aggregated link per facility
+  EXPECT_THAT(model.linear_constraints().ids(), SizeIs(5));
+  const math_opt::SparseDoubleMatrixProto& matrix =
+      model.linear_constraint_matrix();
+  EXPECT_THAT(matrix.row_ids(),
+              ElementsAreArray({0, 0, 1, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4}));
+  EXPECT_THAT(matrix.column_ids(),
+              ElementsAreArray({2, 3, 4, 5, 6, 7, 0, 2, 4, 6, 1, 3, 5, 7}));
+  EXPECT_THAT(matrix.coefficients(),
+              ElementsAreArray({1, 1, 1, 1, 1, 1, -3, 1, 1, 1, -3, 1, 1, 1}));
+}
+
+TEST(SummarizeIterationsTest, TotalsPerPhase) {
+  std::vector<IterationStats> iterations(3);
+  iterations[0].set_phase(IterationStats::PHASE_LP);
+  iterations[0].set_master_seconds(1.5);
+  iterations[0].set_num_cuts(2);
+  iterations[0].set_cut_density(0.5);
+  iterations[1].set_phase(IterationStats::PHASE_LP);
+  iterations[1].set_master_seconds(0.5);
+  iterations[1].set_num_cuts(2);
+  iterations[1].set_cut_density(1.0);
+  iterations[1].set_lower_bound(3);
+  iterations[1].set_upper_bound(4);
+  iterations[2].set_phase(IterationStats::PHASE_INTEGER);
+  iterations[2].set_node_count(7);
+  const std::string summary = SummarizeIterations(iterations);
+  EXPECT_THAT(summary, HasSubstr("LP: 2 iterations"));
+  EXPECT_THAT(summary, HasSubstr("master 2s"));
+  EXPECT_THAT(summary, HasSubstr("4 cuts (density 0.75)"));
+  EXPECT_THAT(summary, HasSubstr("bounds [3, 4]"));
+  EXPECT_THAT(summary, HasSubstr("INTEGER: 1 iterations"));
+  EXPECT_THAT(summary, HasSubstr("7 nodes"));
+  EXPECT_THAT(summary, Not(HasSubstr("SINGLE_TREE")));
+}
+
 TEST(KnapsackTest, EasyInstance) {
   const std::vector<double> open_facilities({0.5, 0.4, 0.3, 0.2, 0.1, 0.0});
   const std::vector<double> result = Knapsack(open_facilities);
@@ -74,6 +226,399 @@ TEST(KnapsackTest, CorrectBounds) {
   EXPECT_THAT(result, Pointwise(DoubleNear(kTolerance), expect));
 }
 
+TEST(KnapsackTest, LongInstance) {
+  std::vector<double> open_facilities(20, 0.05);
+  open_facilities[11] = 0.3;
+  const std::vector<double> result = Knapsack(open_facilities);
+  std::vector<double> expect(15, 0.05);
+  expect[11] = 0.3;
+  expect[14] = 0.05 - (0.05 * 14 + 0.3 - 1);
+  EXPECT_THAT(result, Pointwise(DoubleNear(kTolerance), expect));
+}
+
+TEST(KnapsackTest, SlightlyNegativeValues) {
+  // The sum reaches 1 after two facilities and dips below it again within the
+  // first block if the negative values are not clamped
+  std::vector<double> open_facilities(12, -1e-12);
+  open_facilities[0] = 0.5;
+  open_facilities[1] = 0.5;
+  open_facilities[9] = 0.5;
+  const std::vector<double> result = Knapsack(open_facilities);
+  EXPECT_THAT(result, Pointwise(DoubleNear(kTolerance), {0.5, 0.5}));
+  EXPECT_EQ(SeparateCustomer(open_facilities,
+                             std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9})),
+            2);
+}
+
+TEST(SeparateCustomerTest, GathersThroughIndices) {
+  const std::vector<double> open_values({0.0, 0.4, 0.1, 0.5, 0.3});
+  const std::vector<int> indices({3, 1, 2, 4, 0});
+  std::vector<double> weights(indices.size(), -1.0);
+  const int k = SeparateCustomer(open_values, indices, absl::MakeSpan(weights));
+  EXPECT_EQ(k, 3);
+  EXPECT_THAT(absl::MakeConstSpan(weights).first(k),
+              Pointwise(DoubleNear(kTolerance), {0.5, 0.4, 0.1}));
+}
+
+TEST(SeparateCustomerTest, MatchesKnapsack) {
+  std::vector<double> ys;
+  for (int i = 0; i < 37; i++) {
+    ys.push_back(((i * 17) % 5) * 0.01);
+  }
+  std::vector<int> indices(ys.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  EXPECT_EQ(SeparateCustomer(ys, indices), Knapsack(ys).size());
+  ys[30] = 1.0;
+  EXPECT_EQ(SeparateCustomer(ys, indices), Knapsack(ys).size());
+}
+
+TEST(SeparateCustomerTest, NarrowIndices) {
+  const std::vector<double> open_values({0.0, 0.4, 0.1, 0.5, 0.3});
+  const std::vector<uint16_t> narrow({3, 1, 2, 4, 0});
+  const std::vector<uint32_t> wide(narrow.begin(), narrow.end());
+  EXPECT_EQ(SeparateCustomer(open_values, narrow), 3);
+  EXPECT_EQ(SeparateCustomer(open_values, wide), 3);
+}
+
+BendersCut MakeCut(int group, double sum, std::vector<double> y_coefficients) {
+  BendersCut cut;
+  cut.group = group;
+  cut.sum = sum;
+  cut.y_coefficients = std::move(y_coefficients);
+  return cut;
+}
+
+TEST(SparsifyCutTest, DropsZeros) {
+  const SparseBendersCut cut =
+      SparsifyCut(MakeCut(1, 2.0, {0.0, 0.5, 0.0, 1.5}));
+  EXPECT_EQ(cut.group, 1);
+  EXPECT_EQ(cut.sum, 2.0);
+  EXPECT_THAT(cut.indices, ElementsAreArray({1, 3}));
+  EXPECT_THAT(cut.y_coefficients, ElementsAreArray({0.5, 1.5}));
+  EXPECT_THAT(SparsifyCut(MakeCut(0, 1.0, {0.0, 0.0})).indices, IsEmpty());
+}
+
+TEST(BendersCutPoolTest, RejectsDominatedCuts) {
+  BendersCutPool pool(0);
+  pool.Add(SparsifyCut(MakeCut(0, 2.0, {0.5, 0.5})),
+           math_opt::LinearConstraint());
+  EXPECT_TRUE(pool.IsRedundant(SparsifyCut(MakeCut(0, 2.0, {0.5, 0.5}))));
+  EXPECT_TRUE(pool.IsRedundant(SparsifyCut(MakeCut(0, 1.5, {0.5, 1.0}))));
+  EXPECT_FALSE(pool.IsRedundant(SparsifyCut(MakeCut(0, 2.5, {0.5, 0.5}))));
+  EXPECT_FALSE(pool.IsRedundant(SparsifyCut(MakeCut(0, 2.0, {0.5, 0.4}))));
+  EXPECT_FALSE(pool.IsRedundant(SparsifyCut(MakeCut(1, 2.0, {0.5, 0.5}))));
+  // Missing coefficients are zero
+  EXPECT_FALSE(pool.IsRedundant(SparsifyCut(MakeCut(0, 2.0, {0.5, 0.0}))));
+  pool.Add(SparsifyCut(MakeCut(0, 1.0, {0.0, 0.5})),
+           math_opt::LinearConstraint());
+  EXPECT_TRUE(pool.IsRedundant(SparsifyCut(MakeCut(0, 1.0, {0.0, 0.5}))));
+  EXPECT_TRUE(pool.IsRedundant(SparsifyCut(MakeCut(0, 0.5, {0.25, 0.75}))));
+}
+
+TEST(BendersCutPoolTest, PurgesInactiveCuts) {
+  BendersCutPool pool(2);
+  pool.Add(SparsifyCut(MakeCut(0, 2.0, {1.0, 1.0})),
+           math_opt::LinearConstraint());
+  pool.Add(SparsifyCut(MakeCut(0, 1.0, {0.0, 0.0})),
+           math_opt::LinearConstraint());
+  UFLSolution solution;
+  solution.open_values = {0.5, 0.5};
+  solution.bender_values = {1.0};
+  // Both cuts are tight
+  pool.UpdateSlacks(solution);
+  EXPECT_TRUE(pool.PurgeInactive().empty());
+  solution.bender_values = {1.5};
+  pool.UpdateSlacks(solution);
+  pool.UpdateSlacks(solution);
+  EXPECT_EQ(pool.PurgeInactive().size(), 2);
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(UFLBendersTest, GenerateCut) {
+  UFLProblem problem;
+  problem.num_facilities = 2;
+  problem.num_customers = 2;
+  problem.open_costs = {1.0, 0.5};
+  problem.supply_costs = {{1.0, 0.5}, {0.5, 1.0}};
+  UFLBenders benders(problem, math_opt::SolverType::kGlop);
+  const BendersCut cut = benders.GenerateCut({0.5, 0.5});
+  EXPECT_NEAR(cut.sum, 2.0, kTolerance);
+  EXPECT_THAT(cut.y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {0.5, 0.5}));
+}
+
+TEST(UFLBendersTest, SeparateSkipsSatisfiedCut) {
+  UFLProblem problem;
+  problem.num_facilities = 2;
+  problem.num_customers = 2;
+  problem.open_costs = {1.0, 0.5};
+  problem.supply_costs = {{1.0, 0.5}, {0.5, 1.0}};
+  UFLBenders benders(problem, math_opt::SolverType::kGlop);
+  UFLSolution solution;
+  solution.open_values = {0.5, 0.5};
+  solution.bender_values = {1.0};
+  double supply_cost;
+  EXPECT_THAT(benders.Separate(solution, &supply_cost), SizeIs(1));
+  EXPECT_NEAR(supply_cost, 1.5, kTolerance);
+  solution.bender_values = {1.5};
+  EXPECT_THAT(benders.Separate(solution, &supply_cost), IsEmpty());
+}
+
+TEST(UFLBendersTest, GenerateGroupCutsOnlyViolated) {
+  UFLProblem problem;
+  problem.num_facilities = 2;
+  problem.num_customers = 2;
+  problem.open_costs = {1.0, 0.5};
+  problem.supply_costs = {{1.0, 0.5}, {0.5, 1.0}};
+  UFLBendersOptions options;
+  options.num_cut_groups = 2;
+  UFLBenders benders(problem, math_opt::SolverType::kGlop, options);
+  UFLSolution solution;
+  solution.open_values = {0.5, 0.5};
+  solution.bender_values = {0.0, 0.0};
+  double supply_cost;
+  std::vector<BendersCut> cuts =
+      benders.GenerateGroupCuts(solution, &supply_cost);
+  EXPECT_NEAR(supply_cost, 1.5, kTolerance);
+  ASSERT_EQ(cuts.size(), 2);
+  EXPECT_EQ(cuts[0].group, 0);
+  EXPECT_NEAR(cuts[0].sum, 1.0, kTolerance);
+  EXPECT_THAT(cuts[0].y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {0.0, 0.5}));
+  EXPECT_EQ(cuts[1].group, 1);
+  EXPECT_THAT(cuts[1].y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {0.5, 0.0}));
+
+  solution.bender_values = {0.75, 0.5};
+  cuts = benders.GenerateGroupCuts(solution, &supply_cost);
+  ASSERT_EQ(cuts.size(), 1);
+  EXPECT_EQ(cuts[0].group, 1);
+}
+
+UFLProblem ChainProblem() {
+  UFLProblem problem;
+  problem.num_facilities = 4;
+  problem.num_customers = 1;
+  problem.open_costs = {1.0, 1.0, 1.0, 1.0};
+  problem.supply_costs = {{1.0, 2.0, 3.0, 4.0}};
+  return problem;
+}
+
+// Three facilities and four customers, small enough for every solver test
+UFLProblem SmallProblem() {
+  UFLProblem problem;
+  problem.num_facilities = 3;
+  problem.num_customers = 4;
+  problem.open_costs = {2.0, 3.0, 2.5};
+  problem.supply_costs = {{1, 4, 3}, {4, 1, 2}, {2, 3, 1}, {1, 2, 4}};
+  return problem;
+}
+
+// Unit open costs and distinct, unsorted supply costs without ties
+UFLProblem GeneratedCostProblem(int num_facilities, int num_customers) {
+  UFLProblem problem;
+  problem.num_facilities = num_facilities;
+  problem.num_customers = num_customers;
+  problem.open_costs = std::vector<double>(num_facilities, 1.0);
+  problem.supply_costs = DenseMatrix<double>(num_customers, num_facilities);
+  for (int i = 0; i < num_customers; i++) {
+    for (int j = 0; j < num_facilities; j++) {
+      problem.supply_costs[i][j] = (i * 7 + j * 13) % 11 + 0.1 * j + 0.01 * i;
+    }
+  }
+  return problem;
+}
+
+TEST(UFLBendersTest, ParetoOptimalCutAtDegenerateSolution) {
+  const std::vector<double> open_values({1.0, 0.0, 0.0, 0.0});
+  UFLBenders plain(ChainProblem(), math_opt::SolverType::kGlop);
+  const BendersCut plain_cut = plain.GenerateCut(open_values);
+  EXPECT_NEAR(plain_cut.sum, 1.0, kTolerance);
+  EXPECT_THAT(plain_cut.y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {0.0, 0.0, 0.0, 0.0}));
+
+  // The half open core point is cheapest served by the second facility, so
+  // its cost is the dual that is optimal at both points
+  UFLBendersOptions options;
+  options.core_point = CorePoint::kInterior;
+  UFLBenders pareto(ChainProblem(), math_opt::SolverType::kGlop, options);
+  const BendersCut cut = pareto.GenerateCut(open_values);
+  EXPECT_NEAR(cut.sum, 2.0, kTolerance);
+  EXPECT_THAT(cut.y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {1.0, 0.0, 0.0, 0.0}));
+
+  // Still tight at the master solution
+  UFLSolution solution;
+  solution.open_values = open_values;
+  solution.bender_values = {0.0};
+  double supply_cost;
+  EXPECT_THAT(pareto.Separate(solution, &supply_cost), SizeIs(1));
+  EXPECT_NEAR(supply_cost, 1.0, kTolerance);
+}
+
+TEST(UFLBendersTest, ParetoOptimalCutStopsAtNextOpenFacility) {
+  UFLBendersOptions options;
+  options.core_point = CorePoint::kAverage;
+  UFLBenders benders(ChainProblem(), math_opt::SolverType::kGlop, options);
+  // Moves the core point to {0.25, 0.25, 0.25, 0.75}, which is only served
+  // by the last facility
+  UFLSolution solution;
+  solution.open_values = {0.0, 0.0, 0.0, 1.0};
+  solution.bender_values = {0.0};
+  double supply_cost;
+  benders.Separate(solution, &supply_cost);
+
+  BendersCut cut = benders.GenerateCut({1.0, 0.0, 0.0, 0.0});
+  EXPECT_NEAR(cut.sum, 4.0, kTolerance);
+  EXPECT_THAT(cut.y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {3.0, 2.0, 1.0, 0.0}));
+  // Raising the dual past the cost of an open facility would make the cut
+  // loose at the solution
+  cut = benders.GenerateCut({1.0, 0.5, 0.0, 0.0});
+  EXPECT_NEAR(cut.sum, 2.0, kTolerance);
+  EXPECT_THAT(cut.y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {1.0, 0.0, 0.0, 0.0}));
+  // Not degenerate, the first facilities serve more than the whole demand
+  cut = benders.GenerateCut({0.2, 0.0, 0.9, 0.0});
+  EXPECT_NEAR(cut.sum, 3.0, kTolerance);
+  EXPECT_THAT(cut.y_coefficients,
+              Pointwise(DoubleNear(kTolerance), {2.0, 1.0, 0.0, 0.0}));
+}
+
+TEST(UFLBendersTest, AverageCorePointStaysTight) {
+  UFLBendersOptions options;
+  options.core_point = CorePoint::kAverage;
+  UFLBenders benders(ChainProblem(), math_opt::SolverType::kGlop, options);
+  UFLSolution solution;
+  solution.bender_values = {0.0};
+  double supply_cost;
+  for (const std::vector<double>& open_values :
+       {std::vector<double>({0.0, 0.0, 0.0, 1.0}),
+        std::vector<double>({0.0, 1.0, 0.0, 0.0}),
+        std::vector<double>({1.0, 0.0, 0.0, 0.0})}) {
+    solution.open_values = open_values;
+    EXPECT_THAT(benders.Separate(solution, &supply_cost), SizeIs(1));
+    const int open = std::find(open_values.begin(), open_values.end(), 1.0) -
+                     open_values.begin();
+    EXPECT_NEAR(supply_cost, open + 1.0, kTolerance);
+  }
+}
+
+TEST(ParseCorePointTest, Names) {
+  for (const CorePoint core_point :
+       {CorePoint::kNone, CorePoint::kInterior, CorePoint::kAverage}) {
+    const absl::StatusOr<CorePoint> parsed =
+        ParseCorePoint(CorePointName(core_point));
+    ASSERT_TRUE(parsed.ok()) << parsed.status();
+    EXPECT_EQ(*parsed, core_point);
+  }
+  EXPECT_EQ(ParseCorePoint("median").status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(UFLBendersTest, ParallelCutMatchesSerial) {
+  const UFLProblem problem = GeneratedCostProblem(5, 23);
+  const std::vector<double> open_values({0.3, 0.0, 0.5, 0.1, 0.4});
+  UFLBendersOptions serial_options;
+  serial_options.customers_per_shard = 3;
+  UFLBendersOptions parallel_options = serial_options;
+  parallel_options.num_threads = 4;
+  UFLBenders serial(problem, math_opt::SolverType::kGlop, serial_options);
+  UFLBenders parallel(problem, math_opt::SolverType::kGlop, parallel_options);
+  const BendersCut serial_cut = serial.GenerateCut(open_values);
+  const BendersCut parallel_cut = parallel.GenerateCut(open_values);
+  EXPECT_EQ(serial_cut.sum, parallel_cut.sum);
+  EXPECT_THAT(parallel_cut.y_coefficients,
+              ElementsAreArray(serial_cut.y_coefficients));
+}
+
+// The cut as the unsharded loop over customers computes it
+BendersCut BaselineCut(const UFLProblem& problem,
+                       const std::vector<double>& open_values) {
+  BendersCut cut;
+  cut.y_coefficients.assign(problem.num_facilities, 0.0);
+  for (int i = 0; i < problem.num_customers; i++) {
+    const absl::Span<const double> costs = problem.supply_costs[i];
+    std::vector<int> indices(problem.num_facilities);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::stable_sort(indices.begin(), indices.end(),
+                     [&](int a, int b) { return costs[a] < costs[b]; });
+    std::vector<double> ys;
+    for (const int j : indices) {
+      ys.push_back(open_values[j]);
+    }
+    const int k = Knapsack(ys).size();
+    const double dual = costs[indices[k - 1]];
+    cut.sum += dual;
+    for (int j = 0; j < indices.size() && costs[indices[j]] < dual; j++) {
+      cut.y_coefficients[indices[j]] += dual - costs[indices[j]];
+    }
+  }
+  return cut;
+}
+
+TEST(UFLBendersTest, CutMatchesBaselineLoop) {
+  const UFLProblem problem = GeneratedCostProblem(5, 23);
+  const std::vector<double> open_values({0.3, 0.0, 0.5, 0.1, 0.4});
+  const BendersCut baseline = BaselineCut(problem, open_values);
+  for (const int num_threads : {1, 2, 4}) {
+    for (const int customers_per_shard : {1, 3, 512}) {
+      UFLBendersOptions options;
+      options.num_threads = num_threads;
+      options.customers_per_shard = customers_per_shard;
+      UFLBenders benders(problem, math_opt::SolverType::kGlop, options);
+      const BendersCut cut = benders.GenerateCut(open_values);
+      EXPECT_EQ(cut.sum, baseline.sum)
+          << num_threads << " threads, shards of " << customers_per_shard;
+      EXPECT_THAT(cut.y_coefficients,
+                  ElementsAreArray(baseline.y_coefficients))
+          << num_threads << " threads, shards of " << customers_per_shard;
+    }
+  }
+}
+
+TEST(UFLBendersTest, IncrementalSeparationMatchesFull) {
+  const UFLProblem problem = GeneratedCostProblem(6, 40);
+  // Each master solution changes a few facilities of the previous one
+  const std::vector<std::vector<double>> open_values = {
+      {0.3, 0.0, 0.5, 0.1, 0.4, 0.0}, {0.3, 0.0, 0.5, 0.1, 0.4, 0.2},
+      {0.3, 0.2, 0.5, 0.1, 0.4, 0.2}, {0.0, 0.2, 0.5, 0.1, 0.4, 0.2},
+      {0.0, 0.2, 0.5, 0.1, 0.4, 0.2}, {0.0, 0.0, 1.0, 0.0, 1.0, 0.0},
+      {0.0, 0.0, 1.0, 0.0, 1.0, 1.0}, {1.0, 0.0, 1.0, 0.0, 1.0, 1.0}};
+  for (const int num_groups : {1, 3}) {
+    SCOPED_TRACE(num_groups);
+    UFLBendersOptions options;
+    options.num_cut_groups = num_groups;
+    UFLBenders full(problem, math_opt::SolverType::kGlop, options);
+    options.incremental_separation = true;
+    UFLBenders incremental(problem, math_opt::SolverType::kGlop, options);
+    for (const std::vector<double>& values : open_values) {
+      UFLSolution solution;
+      solution.open_values = values;
+      solution.bender_values.assign(num_groups, 0.0);
+      double expect_cost = 0.0;
+      double cost = 0.0;
+      const std::vector<BendersCut> expect =
+          full.Separate(solution, &expect_cost);
+      const std::vector<BendersCut> cuts =
+          incremental.Separate(solution, &cost);
+      EXPECT_NEAR(cost, expect_cost, 1e-9);
+      ASSERT_EQ(cuts.size(), expect.size());
+      for (int c = 0; c < cuts.size(); c++) {
+        EXPECT_EQ(cuts[c].group, expect[c].group);
+        EXPECT_NEAR(cuts[c].sum, expect[c].sum, 1e-9);
+        EXPECT_THAT(cuts[c].y_coefficients,
+                    Pointwise(DoubleNear(1e-9), expect[c].y_coefficients));
+      }
+    }
+    // Separations changing many customers' critical index are done in full
+    const UFLBendersStats& stats = incremental.stats();
+    EXPECT_GT(stats.num_incremental_separations, 0);
+    EXPECT_LT(stats.num_revisited_customers,
+              stats.num_incremental_separations * problem.num_customers);
+  }
+}
+
 TEST(UFLSolverTest, TwoFacilities) {
   UFLProblem problem;
   problem.num_facilities = 2;
@@ -108,6 +653,414 @@ TEST(UFLSolverTest, OnlySupply) {
   EXPECT_THAT(solution.supply_values, ElementsAreArray(expect_supply));
 }
 
+TEST(UFLSolverTest, MultiCut) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders aggregated(problem, math_opt::SolverType::kGscip);
+  const UFLSolution expect = aggregated.Solve();
+  for (const int num_cut_groups : {2, 4}) {
+    UFLBendersOptions options;
+    options.num_cut_groups = num_cut_groups;
+    UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+    const UFLSolution solution = solver.Solve();
+    EXPECT_NEAR(solution.objective_value, expect.objective_value, kTolerance);
+    const BenchmarkInstance instance = solver.GetModel();
+    EXPECT_EQ(instance.objectives_size(),
+              solver.stats().lp_iterations + solver.stats().integer_iterations +
+                  2);
+    EXPECT_EQ(instance.model_updates_size() + 1, instance.objectives_size());
+  }
+}
+
+TEST(UFLSolverTest, CutPool) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders plain(problem, math_opt::SolverType::kGscip);
+  const UFLSolution expect = plain.Solve();
+  UFLBendersOptions options;
+  options.master.max_inactive_rounds = 1;
+  options.master.filter_redundant_cuts = true;
+  UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = solver.Solve();
+  EXPECT_NEAR(solution.objective_value, expect.objective_value, kTolerance);
+}
+
+TEST(UFLSolverTest, FilteredGroupCutsReachOptimum) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders plain(problem, math_opt::SolverType::kGscip);
+  const UFLSolution expect = plain.Solve();
+  UFLBendersOptions options;
+  options.num_cut_groups = 4;
+  options.master.filter_redundant_cuts = true;
+  UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = solver.Solve();
+  EXPECT_EQ(solution.status, UFLSolveStatus::kOptimal);
+  EXPECT_NEAR(solution.objective_value, expect.objective_value, kTolerance);
+  EXPECT_NEAR(solution.lower_bound, expect.objective_value, kTolerance);
+}
+
+TEST(UFLSolverTest, WarmStart) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders cold(problem, math_opt::SolverType::kGscip);
+  const UFLSolution expect = cold.Solve();
+  UFLBendersOptions options;
+  options.warm_start = true;
+  UFLBenders warm(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = warm.Solve();
+  EXPECT_NEAR(solution.objective_value, expect.objective_value, kTolerance);
+}
+
+TEST(UFLSolverTest, WarmStartPassesHintAndPriorities) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders cold(problem, math_opt::SolverType::kGscip);
+  cold.Solve();
+  const math_opt::SolveArguments cold_args =
+      cold.master().SolveArgumentsFor(math_opt::SolverType::kGscip);
+  EXPECT_THAT(cold_args.model_parameters.solution_hints, IsEmpty());
+  EXPECT_THAT(cold_args.model_parameters.branching_priorities, IsEmpty());
+
+  UFLBendersOptions options;
+  options.warm_start = true;
+  UFLBenders warm(problem, math_opt::SolverType::kGscip, options);
+  warm.Solve();
+  const math_opt::SolveArguments warm_args =
+      warm.master().SolveArgumentsFor(math_opt::SolverType::kGscip);
+  ASSERT_THAT(warm_args.model_parameters.solution_hints, SizeIs(1));
+  EXPECT_THAT(warm_args.model_parameters.solution_hints[0].variable_values,
+              SizeIs(problem.num_facilities));
+  EXPECT_THAT(warm_args.model_parameters.branching_priorities,
+              SizeIs(problem.num_facilities));
+  // A portfolio solver without branching priorities only gets the hint
+  const math_opt::SolveArguments glop_args =
+      warm.master().SolveArgumentsFor(math_opt::SolverType::kGlop);
+  EXPECT_THAT(glop_args.model_parameters.solution_hints, SizeIs(1));
+  EXPECT_THAT(glop_args.model_parameters.branching_priorities, IsEmpty());
+}
+
+TEST(UFLSolverTest, LeanMaster) {
+  const UFLProblem problem = SmallProblem();
+  UFLSolverOptions options;
+  options.num_bender_vars = 2;
+  UFLSolver master(math_opt::SolverType::kGscip, problem, true, options);
+  EXPECT_THAT(master.GetModel().initial_model().variables().ids(), SizeIs(5));
+  UFLSolver direct(math_opt::SolverType::kGscip, problem, false);
+  EXPECT_THAT(direct.GetModel().initial_model().variables().ids(),
+              SizeIs(3 + 3 * 4));
+}
+
+TEST(UFLSolverTest, NoVariableNames) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders named(problem, math_opt::SolverType::kGscip);
+  const UFLSolution expect = named.Solve();
+  UFLBendersOptions options;
+  options.master.variable_names = false;
+  UFLBenders unnamed(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = unnamed.Solve();
+  EXPECT_NEAR(solution.objective_value, expect.objective_value, kTolerance);
+  EXPECT_THAT(unnamed.GetModel().initial_model().variables().names(),
+              Each(IsEmpty()));
+}
+
+TEST(UFLSolverTest, LazyLinks) {
+  const UFLProblem problem = SmallProblem();
+  UFLSolver full(math_opt::SolverType::kGscip, problem, false);
+  const UFLSolution expect = full.Solve();
+  UFLSolverOptions options;
+  options.lazy_links = true;
+  UFLSolver lazy(math_opt::SolverType::kGscip, problem, false, options);
+  const UFLSolution solution = lazy.Solve();
+  EXPECT_NEAR(solution.objective_value, expect.objective_value, kTolerance);
+  EXPECT_THAT(solution.supply_values, SizeIs(4));
+  EXPECT_LE(lazy.num_lazy_links(), 3 * 4);
+  const BenchmarkInstance instance = lazy.GetModel();
+  EXPECT_EQ(instance.model_updates_size() + 1, instance.objectives_size());
+  // At least the relaxation and the integer solve
+  EXPECT_GE(instance.objectives_size(), 2);
+}
+
+TEST(UFLSolverTest, IterationTelemetry) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders solver(problem, math_opt::SolverType::kGscip);
+  const UFLSolution solution = solver.Solve();
+  const UFLBendersStats& stats = solver.stats();
+  // One entry per master solve
+  ASSERT_THAT(solver.iterations(),
+              SizeIs(stats.lp_iterations + stats.integer_iterations + 2));
+  int num_cuts = 0;
+  for (const IterationStats& iteration : solver.iterations()) {
+    EXPECT_NE(iteration.phase(), IterationStats::PHASE_UNSPECIFIED);
+    EXPECT_LE(iteration.lower_bound(),
+              iteration.upper_bound() + kTolerance);
+    num_cuts += iteration.num_cuts();
+  }
+  EXPECT_EQ(num_cuts, stats.num_cuts);
+  EXPECT_EQ(solver.iterations().back().phase(), IterationStats::PHASE_INTEGER);
+  EXPECT_NEAR(solver.iterations().back().lower_bound(),
+              solution.objective_value, kTolerance);
+  EXPECT_EQ(solver.GetModel().iterations_size(), solver.iterations().size());
+}
+
+TEST(UFLSolverTest, LocalSearchIncumbent) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders plain(problem, math_opt::SolverType::kGscip);
+  const double expect = plain.Solve().objective_value;
+  UFLBendersOptions options;
+  options.local_search = true;
+  UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = solver.Solve();
+  EXPECT_EQ(solution.status, UFLSolveStatus::kOptimal);
+  EXPECT_NEAR(solution.objective_value, expect, kTolerance);
+  EXPECT_THAT(solution.open_values, SizeIs(problem.num_facilities));
+  const UFLBendersStats& stats = solver.stats();
+  EXPECT_GE(stats.num_local_search_incumbents, 1);
+  EXPECT_THAT(solver.iterations(),
+              SizeIs(stats.lp_iterations + stats.integer_iterations + 2));
+  for (const IterationStats& iteration : solver.iterations()) {
+    EXPECT_GE(iteration.upper_bound(), expect - kTolerance);
+  }
+}
+
+TEST(UFLSolverTest, StabilizedBenders) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders plain(problem, math_opt::SolverType::kGscip);
+  const double expect = plain.Solve().objective_value;
+  for (const Stabilization stabilization :
+       {Stabilization::kInOut, Stabilization::kTrustRegion}) {
+    SCOPED_TRACE(StabilizationName(stabilization));
+    UFLBendersOptions options;
+    options.stabilization = stabilization;
+    options.trust_region_radius = 0.2;
+    UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+    const UFLSolution solution = solver.Solve();
+    EXPECT_NEAR(solution.objective_value, expect, kTolerance);
+    const UFLBendersStats& stats = solver.stats();
+    EXPECT_THAT(solver.iterations(),
+                SizeIs(stats.lp_iterations + stats.integer_iterations + 2));
+    for (const IterationStats& iteration : solver.iterations()) {
+      EXPECT_LE(iteration.lower_bound(), expect + kTolerance);
+      EXPECT_GE(iteration.upper_bound(), iteration.lower_bound() - kTolerance);
+    }
+    // The trust region bounds are part of the recorded updates
+    const BenchmarkInstance instance = solver.GetModel();
+    EXPECT_EQ(instance.model_updates_size() + 1, instance.objectives_size());
+  }
+}
+
+TEST(UFLSolverTest, BudgetedBenders) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders plain(problem, math_opt::SolverType::kGscip);
+  const UFLSolution expect = plain.Solve();
+  EXPECT_EQ(expect.status, UFLSolveStatus::kOptimal);
+  EXPECT_NEAR(expect.lower_bound, expect.objective_value, kTolerance);
+
+  // A generous budget still solves to optimality
+  UFLBendersOptions options;
+  options.time_limit = absl::Seconds(60);
+  options.relative_gap = 1e-6;
+  UFLBenders budgeted(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = budgeted.Solve();
+  EXPECT_EQ(solution.status, UFLSolveStatus::kOptimal);
+  EXPECT_NEAR(solution.objective_value, expect.objective_value, kTolerance);
+  EXPECT_THAT(solution.supply_values, SizeIs(4));
+
+  // Any solution is within a gap of 100%, so the integer phase stops at the
+  // first one with its bounds
+  options.relative_gap = 1.0;
+  UFLBenders gapped(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution gap_solution = gapped.Solve();
+  EXPECT_NE(gap_solution.status, UFLSolveStatus::kTimeLimit);
+  EXPECT_LE(gap_solution.lower_bound, expect.objective_value + kTolerance);
+  EXPECT_GE(gap_solution.objective_value, expect.objective_value - kTolerance);
+  EXPECT_THAT(gap_solution.supply_values, SizeIs(4));
+  const BenchmarkInstance instance = gapped.GetModel();
+  EXPECT_EQ(instance.model_updates_size() + 1, instance.objectives_size());
+}
+
+TEST(UFLSolverTest, ExpiredBudgetReportsTimeLimit) {
+  const UFLProblem problem = SmallProblem();
+  UFLBendersOptions options;
+  options.time_limit = absl::ZeroDuration();
+  UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = solver.Solve();
+  EXPECT_EQ(solution.status, UFLSolveStatus::kTimeLimit);
+  if (!solution.open_values.empty()) {
+    EXPECT_THAT(solution.supply_values, SizeIs(4));
+  }
+  const UFLBendersStats& stats = solver.stats();
+  EXPECT_THAT(solver.iterations(),
+              SizeIs(stats.lp_iterations + stats.integer_iterations + 2));
+  // Solves without a solution are left out of the recording, only the initial
+  // model may have a NaN placeholder
+  const BenchmarkInstance instance = solver.GetModel();
+  for (int k = 1; k < instance.objectives_size(); k++) {
+    EXPECT_TRUE(std::isfinite(instance.objectives(k))) << k;
+  }
+  EXPECT_EQ(instance.model_updates_size(),
+            std::max(0, instance.objectives_size() - 1));
+}
+
+TEST(UFLSolverTest, ExpiredBudgetStreamReadsBack) {
+  const UFLProblem problem = SmallProblem();
+  const std::string filename =
+      ::testing::TempDir() + "/ufl_expired_budget.pb";
+  absl::StatusOr<std::unique_ptr<StreamRecorder>> recorder =
+      StreamRecorder::Open(filename);
+  ASSERT_TRUE(recorder.ok()) << recorder.status();
+  UFLBendersOptions options;
+  options.time_limit = absl::ZeroDuration();
+  options.master.recorder = recorder->get();
+  UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+  solver.Solve();
+  ASSERT_TRUE((*recorder)->Close().ok());
+  const absl::StatusOr<BenchmarkInstance> instance =
+      ReadBenchmarkStream(filename);
+  ASSERT_TRUE(instance.ok()) << instance.status();
+  EXPECT_EQ(instance->model_updates_size(),
+            std::max(0, instance->objectives_size() - 1));
+}
+
+TEST(UFLSolverTest, FirstRecordedSolveAfterExpiredOneReadsBack) {
+  const UFLProblem problem = SmallProblem();
+  const std::string filename =
+      ::testing::TempDir() + "/ufl_first_recorded_solve.pb";
+  absl::StatusOr<std::unique_ptr<StreamRecorder>> recorder =
+      StreamRecorder::Open(filename);
+  ASSERT_TRUE(recorder.ok()) << recorder.status();
+  UFLSolverOptions options;
+  options.recorder = recorder->get();
+  UFLSolver solver(math_opt::SolverType::kGscip, problem, true, options);
+  UFLSolveLimits expired;
+  expired.deadline = absl::InfinitePast();
+  solver.SetLimits(expired);
+  solver.Solve();
+  // The first solve with a solution then comes with a pending update
+  solver.EnforceInteger();
+  solver.SetLimits(UFLSolveLimits());
+  const UFLSolution solution = solver.Solve();
+  ASSERT_TRUE((*recorder)->Close().ok());
+  const absl::StatusOr<BenchmarkInstance> instance =
+      ReadBenchmarkStream(filename);
+  ASSERT_TRUE(instance.ok()) << instance.status();
+  ASSERT_EQ(instance->objectives_size(), instance->model_updates_size() + 1);
+  EXPECT_NEAR(instance->objectives(instance->objectives_size() - 1),
+              solution.objective_value, kTolerance);
+}
+
+TEST(UFLSolverTest, ExpiredBudgetWithWarmStart) {
+  const UFLProblem problem = SmallProblem();
+  UFLBendersOptions options;
+  options.warm_start = true;
+  options.time_limit = absl::ZeroDuration();
+  UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = solver.Solve();
+  EXPECT_EQ(solution.status, UFLSolveStatus::kTimeLimit);
+  const UFLBendersStats& stats = solver.stats();
+  EXPECT_THAT(solver.iterations(),
+              SizeIs(stats.lp_iterations + stats.integer_iterations + 2));
+}
+
+TEST(ParseStabilizationTest, Names) {
+  for (const Stabilization stabilization :
+       {Stabilization::kNone, Stabilization::kInOut,
+        Stabilization::kTrustRegion}) {
+    const absl::StatusOr<Stabilization> parsed =
+        ParseStabilization(StabilizationName(stabilization));
+    ASSERT_TRUE(parsed.ok()) << parsed.status();
+    EXPECT_EQ(*parsed, stabilization);
+  }
+  EXPECT_EQ(ParseStabilization("bundle").status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ParsePortfolioTest, Names) {
+  const absl::StatusOr<std::vector<math_opt::SolverType>> portfolio =
+      ParsePortfolio("glop,gscip");
+  ASSERT_TRUE(portfolio.ok()) << portfolio.status();
+  EXPECT_THAT(*portfolio, ElementsAreArray({math_opt::SolverType::kGlop,
+                                            math_opt::SolverType::kGscip}));
+  EXPECT_THAT(ParsePortfolio("").value(), IsEmpty());
+  EXPECT_EQ(ParsePortfolio("glop,simplex").status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(UFLSolverTest, Portfolio) {
+  const UFLProblem problem = SmallProblem();
+  UFLBenders single(problem, math_opt::SolverType::kGscip);
+  const double expect = single.Solve().objective_value;
+  UFLBendersOptions options;
+  options.master.portfolio = {math_opt::SolverType::kGlop,
+                              math_opt::SolverType::kGscip};
+  UFLBenders raced(problem, math_opt::SolverType::kGscip, options);
+  const UFLSolution solution = raced.Solve();
+  EXPECT_NEAR(solution.objective_value, expect, kTolerance);
+  const UFLBendersStats& stats = raced.stats();
+  int lp_wins = 0;
+  for (const auto& [solver, wins] : stats.lp_wins) {
+    lp_wins += wins;
+  }
+  EXPECT_EQ(lp_wins, stats.lp_iterations + 1);
+  // GLOP cannot solve the integer master and drops out of the race
+  EXPECT_EQ(stats.integer_wins.count("glop"), 0);
+  for (const IterationStats& iteration : raced.iterations()) {
+    EXPECT_THAT(iteration.solver(), Not(IsEmpty()));
+  }
+}
+
+TEST(UFLSolverTest, SparseCutBatch) {
+  UFLProblem problem;
+  problem.num_facilities = 3;
+  problem.num_customers = 2;
+  problem.open_costs = {1.0, 1.0, 1.0};
+  problem.supply_costs = {{1, 2, 3}, {3, 2, 1}};
+  UFLSolver solver(math_opt::SolverType::kGlop, problem, true);
+  const std::vector<SparseBendersCut> cuts = {
+      SparsifyCut(MakeCut(0, 4.0, {0.0, 1.0, 0.0})),
+      SparsifyCut(MakeCut(0, 3.0, {2.0, 0.0, 1.0}))};
+  EXPECT_EQ(solver.AddBenderCuts(absl::MakeConstSpan(cuts)), 2);
+  const std::optional<math_opt::ModelUpdateProto> update =
+      solver.PendingModelUpdate();
+  ASSERT_TRUE(update.has_value());
+  EXPECT_EQ(update->new_linear_constraints().ids_size(), 2);
+  // Only w and the nonzero y coefficients are set
+  EXPECT_EQ(update->linear_constraint_matrix_updates().coefficients_size(), 5);
+}
+
+TEST(UFLSolverTest, SingleTreeRecordingReplays) {
+  // Lazy constraints need Gurobi, which may not be licensed
+  math_opt::Model probe;
+  if (!math_opt::NewIncrementalSolver(probe, math_opt::SolverType::kGurobi)
+           .ok()) {
+    GTEST_SKIP() << "Gurobi is not available";
+  }
+  const UFLProblem problem = SmallProblem();
+  UFLBendersOptions options;
+  options.single_tree = true;
+  UFLBenders solver(problem, math_opt::SolverType::kGurobi, options);
+  const UFLSolution solution = solver.Solve();
+  const absl::StatusOr<std::vector<ReplayStep>> steps =
+      ReplayInstance(solver.GetModel(), math_opt::SolverType::kGscip);
+  ASSERT_TRUE(steps.ok()) << steps.status();
+  for (const ReplayStep& step : *steps) {
+    EXPECT_TRUE(step.matches) << step.index;
+  }
+  EXPECT_NEAR(steps->back().objective, solution.objective_value, kTolerance);
+}
+
+TEST(UFLSolverTest, ExternalRecorder) {
+  UFLProblem problem;
+  problem.num_facilities = 2;
+  problem.num_customers = 2;
+  problem.open_costs = {1.0, 0.5};
+  problem.supply_costs = {{1.0, 0.5}, {0.5, 1.0}};
+  InstanceRecorder recorder;
+  UFLBendersOptions options;
+  options.master.recorder = &recorder;
+  UFLBenders solver(problem, math_opt::SolverType::kGscip, options);
+  solver.Solve();
+  EXPECT_EQ(solver.GetModel().objectives_size(), 0);
+  EXPECT_GT(recorder.instance().objectives_size(), 0);
+  EXPECT_EQ(recorder.instance().model_updates_size() + 1,
+            recorder.instance().objectives_size());
+}
+
 TEST(UFLSolverTest, OnlyOpen) {
   UFLProblem problem;
   problem.num_facilities = 3;
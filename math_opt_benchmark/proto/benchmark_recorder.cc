@@ -0,0 +1,152 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/proto/benchmark_recorder.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/util/delimited_message_util.h"
+
+namespace math_opt_benchmark {
+
+namespace math_opt = operations_research::math_opt;
+
+//
+// InstanceRecorder
+//
+
+void InstanceRecorder::SetInitialModel(const math_opt::ModelProto& model) {
+  *instance_.mutable_initial_model() = model;
+}
+
+void InstanceRecorder::AddObjective(double objective) {
+  instance_.add_objectives(objective);
+}
+
+void InstanceRecorder::AddModelUpdate(
+    const math_opt::ModelUpdateProto& update) {
+  *instance_.add_model_updates() = update;
+}
+
+void InstanceRecorder::AddIterationStats(const IterationStats& stats) {
+  *instance_.add_iterations() = stats;
+}
+
+//
+// StreamRecorder
+//
+
+absl::StatusOr<std::unique_ptr<StreamRecorder>> StreamRecorder::Open(
+    const std::string& filename) {
+  std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+  if (!output.is_open()) {
+    return absl::NotFoundError(absl::StrCat("Could not open ", filename));
+  }
+  return std::unique_ptr<StreamRecorder>(
+      new StreamRecorder(filename, std::move(output)));
+}
+
+void StreamRecorder::SetInitialModel(const math_opt::ModelProto& model) {
+  BenchmarkRecord record;
+  *record.mutable_initial_model() = model;
+  Write(record);
+}
+
+void StreamRecorder::AddObjective(double objective) {
+  BenchmarkRecord record;
+  record.set_objective(objective);
+  Write(record);
+}
+
+void StreamRecorder::AddModelUpdate(const math_opt::ModelUpdateProto& update) {
+  BenchmarkRecord record;
+  *record.mutable_model_update() = update;
+  Write(record);
+}
+
+void StreamRecorder::AddIterationStats(const IterationStats& stats) {
+  BenchmarkRecord record;
+  *record.mutable_iteration() = stats;
+  Write(record);
+}
+
+void StreamRecorder::Write(const BenchmarkRecord& record) {
+  if (!status_.ok()) {
+    return;
+  }
+  if (!google::protobuf::util::SerializeDelimitedToOstream(record, &output_)) {
+    status_ = absl::DataLossError(absl::StrCat("Failed writing ", filename_));
+  }
+}
+
+absl::Status StreamRecorder::Close() {
+  output_.close();
+  if (status_.ok() && output_.fail()) {
+    status_ = absl::DataLossError(absl::StrCat("Failed closing ", filename_));
+  }
+  return status_;
+}
+
+//
+// HELPER FUNCTIONS
+//
+
+absl::StatusOr<BenchmarkInstance> ReadBenchmarkStream(
+    const std::string& filename) {
+  std::ifstream input(filename, std::ios::binary);
+  if (!input.is_open()) {
+    return absl::NotFoundError(absl::StrCat("Could not open ", filename));
+  }
+  google::protobuf::io::IstreamInputStream stream(&input);
+  BenchmarkInstance instance;
+  BenchmarkRecord record;
+  bool clean_eof = false;
+  int num_records = 0;
+  while (google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+      &record, &stream, &clean_eof)) {
+    switch (record.record_case()) {
+      case BenchmarkRecord::kInitialModel:
+        if (num_records != 0) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              filename, ": initial model at record ", num_records));
+        }
+        *instance.mutable_initial_model() =
+            std::move(*record.mutable_initial_model());
+        break;
+      case BenchmarkRecord::kObjective:
+        instance.add_objectives(record.objective());
+        break;
+      case BenchmarkRecord::kModelUpdate:
+        *instance.add_model_updates() =
+            std::move(*record.mutable_model_update());
+        break;
+      case BenchmarkRecord::kIteration:
+        *instance.add_iterations() = std::move(*record.mutable_iteration());
+        break;
+      case BenchmarkRecord::RECORD_NOT_SET:
+        return absl::InvalidArgumentError(
+            absl::StrCat(filename, ": empty record ", num_records));
+    }
+    num_records++;
+  }
+  if (!clean_eof) {
+    return absl::DataLossError(absl::StrCat(
+        filename, ": truncated or corrupt after record ", num_records));
+  }
+  return instance;
+}
+
+}  // namespace math_opt_benchmark
@@ -0,0 +1,91 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MATH_OPT_BENCHMARK_PROTO_BENCHMARK_RECORDER_H_
+#define MATH_OPT_BENCHMARK_PROTO_BENCHMARK_RECORDER_H_
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "math_opt_benchmark/proto/model.pb.h"
+#include "ortools/math_opt/model.pb.h"
+#include "ortools/math_opt/model_update.pb.h"
+
+namespace math_opt_benchmark {
+
+// Receives a BenchmarkInstance piece by piece while it is being recorded.
+class BenchmarkRecorder {
+ public:
+  virtual ~BenchmarkRecorder() = default;
+  virtual void SetInitialModel(
+      const operations_research::math_opt::ModelProto &model) = 0;
+  virtual void AddObjective(double objective) = 0;
+  virtual void AddModelUpdate(
+      const operations_research::math_opt::ModelUpdateProto &update) = 0;
+  virtual void AddIterationStats(const IterationStats &stats) = 0;
+};
+
+// Keeps the whole instance in memory
+class InstanceRecorder : public BenchmarkRecorder {
+ public:
+  void SetInitialModel(
+      const operations_research::math_opt::ModelProto &model) override;
+  void AddObjective(double objective) override;
+  void AddModelUpdate(
+      const operations_research::math_opt::ModelUpdateProto &update) override;
+  void AddIterationStats(const IterationStats &stats) override;
+
+  const BenchmarkInstance &instance() const { return instance_; }
+
+ private:
+  BenchmarkInstance instance_;
+};
+
+// Appends every piece to a file as a length-delimited BenchmarkRecord, so
+// memory use does not grow with the number of updates.
+class StreamRecorder : public BenchmarkRecorder {
+ public:
+  static absl::StatusOr<std::unique_ptr<StreamRecorder>> Open(
+      const std::string &filename);
+
+  void SetInitialModel(
+      const operations_research::math_opt::ModelProto &model) override;
+  void AddObjective(double objective) override;
+  void AddModelUpdate(
+      const operations_research::math_opt::ModelUpdateProto &update) override;
+  void AddIterationStats(const IterationStats &stats) override;
+
+  // Flushes and closes the file. Returns the first write error, if any.
+  absl::Status Close();
+
+ private:
+  StreamRecorder(const std::string &filename, std::ofstream output)
+      : filename_(filename), output_(std::move(output)) {}
+  void Write(const BenchmarkRecord &record);
+
+  std::string filename_;
+  std::ofstream output_;
+  absl::Status status_;
+};
+
+// Rebuilds the BenchmarkInstance written by a StreamRecorder
+absl::StatusOr<BenchmarkInstance> ReadBenchmarkStream(
+    const std::string &filename);
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_PROTO_BENCHMARK_RECORDER_H_
@@ -0,0 +1,103 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/proto/benchmark_recorder.h"
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "math_opt_benchmark/proto/model.pb.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+namespace math_opt = ::operations_research::math_opt;
+using ::testing::ElementsAre;
+
+void RecordExample(BenchmarkRecorder& recorder) {
+  math_opt::ModelProto model;
+  model.set_name("example");
+  recorder.SetInitialModel(model);
+  recorder.AddObjective(1.5);
+  math_opt::ModelUpdateProto update;
+  update.add_deleted_linear_constraint_ids(3);
+  recorder.AddModelUpdate(update);
+  recorder.AddObjective(2.5);
+  IterationStats stats;
+  stats.set_phase(IterationStats::PHASE_LP);
+  stats.set_lower_bound(2.5);
+  stats.set_num_cuts(1);
+  recorder.AddIterationStats(stats);
+}
+
+TEST(InstanceRecorderTest, KeepsInstance) {
+  InstanceRecorder recorder;
+  RecordExample(recorder);
+  const BenchmarkInstance& instance = recorder.instance();
+  EXPECT_EQ(instance.initial_model().name(), "example");
+  EXPECT_THAT(instance.objectives(), ElementsAre(1.5, 2.5));
+  ASSERT_EQ(instance.model_updates_size(), 1);
+  EXPECT_THAT(instance.model_updates(0).deleted_linear_constraint_ids(),
+              ElementsAre(3));
+  ASSERT_EQ(instance.iterations_size(), 1);
+  EXPECT_EQ(instance.iterations(0).num_cuts(), 1);
+}
+
+TEST(StreamRecorderTest, RoundTrip) {
+  const std::string filename = ::testing::TempDir() + "/round_trip.pb";
+  absl::StatusOr<std::unique_ptr<StreamRecorder>> recorder =
+      StreamRecorder::Open(filename);
+  ASSERT_TRUE(recorder.ok()) << recorder.status();
+  RecordExample(**recorder);
+  ASSERT_TRUE((*recorder)->Close().ok());
+
+  const absl::StatusOr<BenchmarkInstance> instance =
+      ReadBenchmarkStream(filename);
+  ASSERT_TRUE(instance.ok()) << instance.status();
+  InstanceRecorder expected;
+  RecordExample(expected);
+  EXPECT_EQ(instance->SerializeAsString(),
+            expected.instance().SerializeAsString());
+}
+
+TEST(StreamRecorderTest, DetectsTruncation) {
+  const std::string filename = ::testing::TempDir() + "/truncated.pb";
+  absl::StatusOr<std::unique_ptr<StreamRecorder>> recorder =
+      StreamRecorder::Open(filename);
+  ASSERT_TRUE(recorder.ok()) << recorder.status();
+  RecordExample(**recorder);
+  ASSERT_TRUE((*recorder)->Close().ok());
+
+  std::string contents;
+  {
+    std::ifstream input(filename, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(input),
+                    std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+    output << contents.substr(0, contents.size() - 3);
+  }
+  EXPECT_EQ(ReadBenchmarkStream(filename).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
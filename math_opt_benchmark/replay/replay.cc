@@ -0,0 +1,137 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/replay/replay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "ortools/base/status_macros.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace math_opt_benchmark {
+namespace {
+namespace math_opt = ::operations_research::math_opt;
+
+absl::StatusOr<ReplayStep> SolveStep(math_opt::IncrementalSolver& solver,
+                                     const BenchmarkInstance& instance,
+                                     const ReplayOptions& options, int index,
+                                     absl::Duration update_time) {
+  ReplayStep step;
+  step.index = index;
+  step.update_time = update_time;
+  const absl::Time start = absl::Now();
+  ASSIGN_OR_RETURN(const math_opt::SolveResult result, solver.Solve());
+  step.solve_time = absl::Now() - start;
+  step.termination = result.termination.reason;
+  step.recorded_objective = instance.objectives(index);
+  if (std::isnan(step.recorded_objective)) {
+    // Nothing was recorded to compare with
+    step.objective = step.termination == math_opt::TerminationReason::kOptimal
+                         ? result.objective_value()
+                         : std::nan("");
+    step.matches = true;
+  } else if (step.termination == math_opt::TerminationReason::kOptimal) {
+    step.objective = result.objective_value();
+    step.matches =
+        std::abs(step.objective - step.recorded_objective) <=
+        options.tolerance * std::max(1.0, std::abs(step.recorded_objective));
+  } else {
+    step.objective = std::nan("");
+    step.matches = false;
+  }
+  return step;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<ReplayStep>> ReplayInstance(
+    const BenchmarkInstance& instance, math_opt::SolverType solver_type,
+    const ReplayOptions& options) {
+  if (instance.objectives_size() != instance.model_updates_size() + 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected one objective more than model updates, got ",
+        instance.objectives_size(), " objectives and ",
+        instance.model_updates_size(), " updates"));
+  }
+  ASSIGN_OR_RETURN(std::unique_ptr<math_opt::Model> model,
+                   math_opt::Model::FromModelProto(instance.initial_model()));
+  ASSIGN_OR_RETURN(std::unique_ptr<math_opt::IncrementalSolver> solver,
+                   math_opt::NewIncrementalSolver(*model, solver_type));
+
+  std::vector<ReplayStep> steps;
+  steps.reserve(instance.objectives_size());
+  ASSIGN_OR_RETURN(ReplayStep initial,
+                   SolveStep(*solver, instance, options, 0, absl::ZeroDuration()));
+  steps.push_back(initial);
+  for (int k = 0; k < instance.model_updates_size(); k++) {
+    const absl::Time start = absl::Now();
+    RETURN_IF_ERROR(model->ApplyUpdateProto(instance.model_updates(k)));
+    RETURN_IF_ERROR(solver->Update().status());
+    const absl::Duration update_time = absl::Now() - start;
+    ASSIGN_OR_RETURN(ReplayStep step, SolveStep(*solver, instance, options,
+                                                k + 1, update_time));
+    steps.push_back(step);
+  }
+  return steps;
+}
+
+std::string StepsToCsv(const std::vector<ReplayStep>& steps) {
+  std::string csv =
+      "step,update_seconds,solve_seconds,termination,objective,"
+      "recorded_objective,matches\n";
+  for (const ReplayStep& step : steps) {
+    absl::StrAppend(&csv, step.index, ",",
+                    absl::ToDoubleSeconds(step.update_time), ",",
+                    absl::ToDoubleSeconds(step.solve_time), ",",
+                    math_opt::EnumToString(step.termination), ",",
+                    step.objective, ",", step.recorded_objective, ",",
+                    step.matches ? "true" : "false", "\n");
+  }
+  return csv;
+}
+
+std::string StepsToJson(const std::vector<ReplayStep>& steps) {
+  std::string json = "[";
+  for (int i = 0; i < steps.size(); i++) {
+    const ReplayStep& step = steps[i];
+    // JSON has no NaN, non-optimal steps report a null objective and steps
+    // without a recorded objective a null recorded_objective
+    const std::string objective = std::isnan(step.objective)
+                                      ? "null"
+                                      : absl::StrCat(step.objective);
+    const std::string recorded_objective =
+        std::isnan(step.recorded_objective)
+            ? "null"
+            : absl::StrCat(step.recorded_objective);
+    absl::StrAppend(&json, i == 0 ? "\n" : ",\n", "  {\"step\": ", step.index,
+                    ", \"update_seconds\": ",
+                    absl::ToDoubleSeconds(step.update_time),
+                    ", \"solve_seconds\": ",
+                    absl::ToDoubleSeconds(step.solve_time),
+                    ", \"termination\": \"",
+                    math_opt::EnumToString(step.termination),
+                    "\", \"objective\": ", objective,
+                    ", \"recorded_objective\": ", recorded_objective,
+                    ", \"matches\": ", step.matches ? "true" : "false", "}");
+  }
+  absl::StrAppend(&json, "\n]\n");
+  return json;
+}
+
+}  // namespace math_opt_benchmark
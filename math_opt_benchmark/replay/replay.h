@@ -0,0 +1,70 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays a recorded BenchmarkInstance against any MathOpt solver:
+//
+// solve initial_model, then for each k apply model_updates(k) and re-solve,
+// comparing each optimum with objectives(k + 1).
+//
+// Only the recorded models are needed, not the problem data they came from.
+
+#ifndef MATH_OPT_BENCHMARK_REPLAY_REPLAY_H_
+#define MATH_OPT_BENCHMARK_REPLAY_REPLAY_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "math_opt_benchmark/proto/model.pb.h"
+#include "third_party/ortools/ortools/math_opt/cpp/math_opt.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace math_opt_benchmark {
+
+struct ReplayOptions {
+  // Objectives match if they differ by at most tolerance * max(1, |recorded|)
+  double tolerance = 1e-5;
+};
+
+struct ReplayStep {
+  // 0 is the initial model, k > 0 the model after model_updates(k - 1)
+  int index;
+  // Time to apply the update to the model and the incremental solver
+  absl::Duration update_time;
+  absl::Duration solve_time;
+  operations_research::math_opt::TerminationReason termination;
+  double objective;
+  // NaN if the recording has no objective for this step, which then matches
+  double recorded_objective;
+  bool matches;
+};
+
+// Solves every model in `instance` in turn with a single incremental solver.
+// Returns an error if the instance is inconsistent or a solve fails. A
+// non-optimal termination or a different objective is reported in the step.
+absl::StatusOr<std::vector<ReplayStep>> ReplayInstance(
+    const BenchmarkInstance &instance,
+    operations_research::math_opt::SolverType solver_type,
+    const ReplayOptions &options = ReplayOptions());
+
+// One row per step, with a header line
+std::string StepsToCsv(const std::vector<ReplayStep> &steps);
+
+// A JSON array with one object per step
+std::string StepsToJson(const std::vector<ReplayStep> &steps);
+
+}  // namespace math_opt_benchmark
+
+#endif  // MATH_OPT_BENCHMARK_REPLAY_REPLAY_H_
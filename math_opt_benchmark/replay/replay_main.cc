@@ -0,0 +1,93 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ortools/base/init_google.h"
+#include "ortools/base/file.h"
+#include "absl/flags/flag.h"
+#include "absl/status/statusor.h"
+#include "math_opt_benchmark/proto/benchmark_recorder.h"
+#include "math_opt_benchmark/proto/model.pb.h"
+#include "math_opt_benchmark/replay/replay.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+ABSL_FLAG(std::string, input, "", "Path to a recorded BenchmarkInstance.");
+ABSL_FLAG(std::string, input_format, "stream",
+          "\"stream\" for the length-delimited records written by "
+          "StreamRecorder, \"binary\" or \"text\" for a single proto.");
+ABSL_FLAG(operations_research::math_opt::SolverType, solver,
+          operations_research::math_opt::SolverType::kGlop,
+          "The solver to replay the instance with.");
+ABSL_FLAG(double, tolerance, 1e-5,
+          "Relative tolerance when comparing with the recorded objectives.");
+ABSL_FLAG(std::string, output, "", "Where to write the results, or stdout.");
+ABSL_FLAG(bool, json, false, "Write the results as JSON instead of CSV.");
+
+namespace math_opt_benchmark {
+namespace {
+
+// Returns false if any step does not match the recorded objective
+bool Main() {
+  const std::string input = absl::GetFlag(FLAGS_input);
+  const std::string input_format = absl::GetFlag(FLAGS_input_format);
+  BenchmarkInstance instance;
+  if (input_format == "stream") {
+    absl::StatusOr<BenchmarkInstance> read = ReadBenchmarkStream(input);
+    CHECK_OK(read.status());
+    instance = *std::move(read);
+  } else if (input_format == "binary") {
+    CHECK_OK(file::GetBinaryProto(input, &instance, file::Defaults()));
+  } else if (input_format == "text") {
+    CHECK_OK(file::GetTextProto(input, &instance, file::Defaults()));
+  } else {
+    LOG(FATAL) << "Unknown --input_format " << input_format;
+  }
+
+  ReplayOptions options;
+  options.tolerance = absl::GetFlag(FLAGS_tolerance);
+  const absl::StatusOr<std::vector<ReplayStep>> steps =
+      ReplayInstance(instance, absl::GetFlag(FLAGS_solver), options);
+  CHECK_OK(steps.status());
+
+  const std::string results =
+      absl::GetFlag(FLAGS_json) ? StepsToJson(*steps) : StepsToCsv(*steps);
+  const std::string output = absl::GetFlag(FLAGS_output);
+  if (output.empty()) {
+    std::cout << results;
+  } else {
+    CHECK_OK(file::SetContents(output, results, file::Defaults()));
+  }
+
+  bool all_match = true;
+  for (const ReplayStep& step : *steps) {
+    if (!step.matches) {
+      std::cerr << "Step " << step.index << " objective " << step.objective
+                << " differs from recorded " << step.recorded_objective
+                << std::endl;
+      all_match = false;
+    }
+  }
+  return all_match;
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark
+
+int main(int argc, char** argv) {
+  InitGoogle(argv[0], &argc, &argv, true);
+  return math_opt_benchmark::Main() ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Copyright 2026 The MathOpt Benchmark Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "math_opt_benchmark/replay/replay.h"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "math_opt_benchmark/proto/model.pb.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace math_opt_benchmark {
+namespace {
+
+namespace math_opt = ::operations_research::math_opt;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+using ::testing::StartsWith;
+
+constexpr double kTolerance = 1e-5;
+
+// max x + 2y s.t. x + y <= 1.5, x, y in [0, 1], then y <= 0.5
+BenchmarkInstance TwoStepInstance() {
+  math_opt::Model model("replay_test");
+  const math_opt::Variable x = model.AddContinuousVariable(0.0, 1.0, "x");
+  const math_opt::Variable y = model.AddContinuousVariable(0.0, 1.0, "y");
+  model.AddLinearConstraint(x + y <= 1.5);
+  model.Maximize(x + 2 * y);
+  BenchmarkInstance instance;
+  *instance.mutable_initial_model() = model.ExportModel();
+  instance.add_objectives(2.5);
+  std::unique_ptr<math_opt::UpdateTracker> tracker = model.NewUpdateTracker();
+  model.set_upper_bound(y, 0.5);
+  *instance.add_model_updates() = tracker->ExportModelUpdate().value();
+  instance.add_objectives(2.0);
+  return instance;
+}
+
+TEST(ReplayTest, MatchesRecordedObjectives) {
+  const absl::StatusOr<std::vector<ReplayStep>> steps =
+      ReplayInstance(TwoStepInstance(), math_opt::SolverType::kGlop);
+  ASSERT_TRUE(steps.ok()) << steps.status();
+  ASSERT_THAT(*steps, SizeIs(2));
+  for (const ReplayStep& step : *steps) {
+    EXPECT_TRUE(step.matches) << step.index;
+  }
+  EXPECT_NEAR((*steps)[1].objective, 2.0, kTolerance);
+}
+
+TEST(ReplayTest, ReportsMismatch) {
+  BenchmarkInstance instance = TwoStepInstance();
+  instance.set_objectives(1, 3.0);
+  const absl::StatusOr<std::vector<ReplayStep>> steps =
+      ReplayInstance(instance, math_opt::SolverType::kGlop);
+  ASSERT_TRUE(steps.ok()) << steps.status();
+  EXPECT_TRUE((*steps)[0].matches);
+  EXPECT_FALSE((*steps)[1].matches);
+}
+
+TEST(ReplayTest, SkipsPlaceholderObjective) {
+  BenchmarkInstance instance = TwoStepInstance();
+  instance.set_objectives(0, std::numeric_limits<double>::quiet_NaN());
+  const absl::StatusOr<std::vector<ReplayStep>> steps =
+      ReplayInstance(instance, math_opt::SolverType::kGlop);
+  ASSERT_TRUE(steps.ok()) << steps.status();
+  EXPECT_TRUE((*steps)[0].matches);
+  EXPECT_NEAR((*steps)[0].objective, 2.5, kTolerance);
+  EXPECT_TRUE((*steps)[1].matches);
+  EXPECT_THAT(StepsToJson(*steps), HasSubstr("\"recorded_objective\": null"));
+}
+
+TEST(ReplayTest, RejectsMissingObjectives) {
+  BenchmarkInstance instance = TwoStepInstance();
+  instance.mutable_objectives()->RemoveLast();
+  EXPECT_EQ(ReplayInstance(instance, math_opt::SolverType::kGlop)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ReplayTest, Formats) {
+  const absl::StatusOr<std::vector<ReplayStep>> steps =
+      ReplayInstance(TwoStepInstance(), math_opt::SolverType::kGlop);
+  ASSERT_TRUE(steps.ok()) << steps.status();
+  EXPECT_THAT(StepsToCsv(*steps), StartsWith("step,update_seconds"));
+  EXPECT_THAT(StepsToJson(*steps), HasSubstr("\"matches\": true"));
+}
+
+}  // namespace
+}  // namespace math_opt_benchmark